@@ -0,0 +1,231 @@
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include "catch.hpp"
+#include "broadcast.hpp"
+
+using gto::broadcast;
+using gto::broadcast_mode;
+
+namespace {
+
+template<typename Segments>
+auto collect(const Segments &segs) {
+  std::vector<std::remove_const_t<typename Segments::first_type::element_type>> ret;
+  ret.insert(ret.end(), segs.first.begin(), segs.first.end());
+  ret.insert(ret.end(), segs.second.begin(), segs.second.end());
+  return ret;
+}
+
+template<typename T>
+std::vector<T> copy(broadcast<T> &ring, typename broadcast<T>::reader_id id, std::size_t n) {
+  std::vector<T> ret(n);
+  ret.resize(ring.read(id, std::span<T>(ret)));
+  return ret;
+}
+
+} // unnamed namespace
+
+TEST_CASE("broadcast") {
+
+  SECTION("constructor") {
+    broadcast<int> ring(5);
+    CHECK(ring.capacity() == 8);
+    CHECK(ring.readers() == 0);
+    CHECK(ring.sequence() == 0);
+    CHECK(ring.mode() == broadcast_mode::block);
+    CHECK_THROWS_AS(broadcast<int>(0), std::length_error);
+    CHECK_THROWS_AS(broadcast<std::string>(8, broadcast_mode::overwrite), std::invalid_argument);
+  }
+
+  SECTION("subscribe") {
+    broadcast<int> ring(8, broadcast_mode::block, 3);
+    auto r1 = ring.subscribe();
+    auto r2 = ring.subscribe();
+    CHECK(r1 != r2);
+    CHECK(ring.readers() == 2);
+    ring.unsubscribe(r1);
+    CHECK(ring.readers() == 1);
+    CHECK_THROWS(ring.available(r1));
+    CHECK_THROWS(ring.unsubscribe(r1));
+    CHECK_THROWS(ring.read(99));
+    // slot reused
+    CHECK(ring.subscribe() == r1);
+    ring.subscribe();
+    CHECK_THROWS_AS(ring.subscribe(), std::length_error);
+    // new readers start at the next item
+    ring.unsubscribe(r1);
+    ring.push(1);
+    auto r3 = ring.subscribe();
+    CHECK(ring.available(r2) == 1);
+    CHECK(ring.available(r3) == 0);
+  }
+
+  SECTION("independent cursors") {
+    broadcast<std::string> ring(8);
+    auto r1 = ring.subscribe();
+    auto r2 = ring.subscribe();
+    ring.push("a");
+    ring.push("b");
+    ring.push("c");
+    CHECK(ring.available(r1) == 3);
+    CHECK(collect(ring.read(r1)) == std::vector<std::string>{"a", "b", "c"});
+    CHECK(collect(ring.read(r1, 2)) == std::vector<std::string>{"a", "b"});
+    CHECK(ring.consume(r1, 2));
+    CHECK(ring.available(r1) == 1);
+    CHECK(ring.available(r2) == 3);
+    CHECK(collect(ring.read(r1)) == std::vector<std::string>{"c"});
+    // items shared, not copied
+    CHECK(ring.read(r1).first.data() == ring.read(r2, 3).first.data() + 2);
+    ring.consume(r1, 10);
+    CHECK(ring.available(r1) == 0);
+    CHECK(ring.read(r1).first.empty());
+    CHECK(collect(ring.read(r2)) == std::vector<std::string>{"a", "b", "c"});
+    // copies
+    broadcast<int> ints(4);
+    auto r3 = ints.subscribe();
+    ints.push(1);
+    ints.push(2);
+    CHECK(copy(ints, r3, 1) == std::vector<int>{1});
+    CHECK(copy(ints, r3, 5) == std::vector<int>{1, 2});
+    CHECK(ints.available(r3) == 2);
+  }
+
+  SECTION("block mode") {
+    broadcast<int> ring(4);
+    auto r1 = ring.subscribe();
+    auto r2 = ring.subscribe();
+    for (int i = 0; i < 4; i++) {
+      CHECK(ring.try_push(i));
+    }
+    CHECK(!ring.try_push(4));
+    // gated by the slowest reader
+    ring.consume(r1, 4);
+    CHECK(!ring.try_push(4));
+    ring.consume(r2, 1);
+    CHECK(ring.try_push(4));
+    CHECK(!ring.try_push(5));
+    CHECK(ring.available(r1) == 1);
+    CHECK(ring.available(r2) == 4);
+    // unsubscribed readers do not gate
+    ring.unsubscribe(r2);
+    ring.push(5);
+    CHECK(collect(ring.read(r1)) == std::vector<int>{4, 5});
+  }
+
+  SECTION("overwrite mode") {
+    broadcast<int> ring(4, broadcast_mode::overwrite);
+    auto r1 = ring.subscribe();
+    auto r2 = ring.subscribe();
+    for (int i = 0; i < 6; i++) {
+      CHECK(ring.try_push(i));
+      CHECK(ring.consume(r1, 1));
+    }
+    CHECK(ring.available(r1) == 0);
+    CHECK(ring.available(r2) == 6);
+    // in-place views would race with the producer
+    CHECK_THROWS_AS(ring.read(r2), std::logic_error);
+    CHECK(copy(ring, r2, 10) == std::vector<int>{2, 3, 4, 5});
+    CHECK(ring.missed(r1) == 0);
+    CHECK(ring.missed(r2) == 2);
+    CHECK(ring.sequence() == 6);
+    // batch overwritten between read and consume
+    CHECK(copy(ring, r2, 2) == std::vector<int>{2, 3});
+    ring.push(6);
+    CHECK(!ring.consume(r2, 2));
+    CHECK(ring.missed(r2) == 4);
+    CHECK(copy(ring, r2, 10) == std::vector<int>{4, 5, 6});
+    CHECK(ring.consume(r2, 3));
+  }
+
+  SECTION("no readers") {
+    broadcast<int> ring(4);
+    for (int i = 0; i < 100; i++) {
+      CHECK(ring.try_push(i));
+    }
+    CHECK(ring.sequence() == 100);
+  }
+
+  SECTION("wrapped segments") {
+    broadcast<int> ring(8);
+    auto r1 = ring.subscribe();
+    for (int i = 0; i < 6; i++) {
+      ring.push(i);
+    }
+    ring.consume(r1, 6);
+    for (int i = 6; i < 12; i++) {
+      ring.push(i);
+    }
+    auto segs = ring.read(r1);
+    CHECK(!segs.second.empty());
+    CHECK(collect(segs) == std::vector<int>{6, 7, 8, 9, 10, 11});
+  }
+
+  SECTION("concurrent block mode") {
+    constexpr std::uint64_t NUM_ITEMS = 200000;
+    constexpr int NUM_READERS = 3;
+    broadcast<std::uint64_t> ring(64);
+    std::vector<broadcast<std::uint64_t>::reader_id> ids;
+    for (int i = 0; i < NUM_READERS; i++) {
+      ids.push_back(ring.subscribe());
+    }
+    std::vector<std::uint64_t> errors(NUM_READERS, 0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < NUM_READERS; i++) {
+      readers.emplace_back([&ring, &errors, id = ids[static_cast<std::size_t>(i)], i]() {
+        std::uint64_t expected = 0;
+        while (expected < NUM_ITEMS) {
+          // different batch sizes per reader
+          auto [seg1, seg2] = ring.read(id, static_cast<std::size_t>(7 * i + 1));
+          for (auto val : seg1) errors[static_cast<std::size_t>(i)] += (val != expected++);
+          for (auto val : seg2) errors[static_cast<std::size_t>(i)] += (val != expected++);
+          ring.consume(id, seg1.size() + seg2.size());
+        }
+      });
+    }
+    for (std::uint64_t i = 0; i < NUM_ITEMS; i++) {
+      ring.push(i);
+    }
+    for (auto &thread : readers) {
+      thread.join();
+    }
+    for (int i = 0; i < NUM_READERS; i++) {
+      CHECK(errors[static_cast<std::size_t>(i)] == 0);
+      CHECK(ring.missed(ids[static_cast<std::size_t>(i)]) == 0);
+    }
+  }
+
+  SECTION("concurrent overwrite mode") {
+    constexpr std::uint64_t NUM_ITEMS = 200000;
+    broadcast<std::uint64_t> ring(16, broadcast_mode::overwrite);
+    auto id = ring.subscribe();
+    std::uint64_t received = 0;
+    std::uint64_t errors = 0;
+    std::thread reader([&]() {
+      std::uint64_t last = 0;
+      while (last + 1 < NUM_ITEMS) {
+        auto batch = copy(ring, id, 4);
+        if (!ring.consume(id, batch.size())) {
+          continue;
+        }
+        // valid batches are increasing and consecutive
+        for (std::size_t i = 0; i < batch.size(); i++) {
+          errors += (i > 0 && batch[i] != batch[i - 1] + 1);
+          errors += (received > 0 && batch[i] <= last);
+          last = batch[i];
+          received++;
+        }
+      }
+    });
+    for (std::uint64_t i = 0; i < NUM_ITEMS; i++) {
+      ring.push(i);
+    }
+    reader.join();
+    CHECK(errors == 0);
+    CHECK(received + ring.missed(id) == NUM_ITEMS);
+  }
+
+}
@@ -0,0 +1,477 @@
+#pragma once
+
+#include <span>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "cqueue.hpp"
+
+namespace gto {
+
+//! Behavior of broadcast::push() when the ring is full.
+enum class broadcast_mode {
+  //! Producer is gated by the slowest reader (push waits).
+  block,
+  //! Oldest item is overwritten (lagging readers skip it).
+  overwrite
+};
+
+/**
+ * @brief Single-producer multi-consumer broadcast ring (Disruptor-style).
+ *
+ * @details One producer thread publishes items into a fixed ring of slots
+ *          (a power of 2, stored once in a cqueue) and every reader thread
+ *          consumes all of them with its own cursor. The published sequence
+ *          and the reader cursors are atomics (release/acquire), so neither
+ *          the producer nor the readers take locks. Readers get batches of
+ *          published items in place as contiguous segments and then
+ *          advance their cursor with consume().
+ *          When the ring is full the producer is either gated by the
+ *          slowest reader cursor (broadcast_mode::block) or overwrites the
+ *          oldest slot (broadcast_mode::overwrite). In the latter case the
+ *          lagging readers skip the lost items, counted in missed() (lag
+ *          detection). A slot can then be rewritten while it is being read,
+ *          so T must be trivially copyable, slots are copied with relaxed
+ *          atomic byte accesses (no in-place views), and consume() reports
+ *          if the batch was overwritten during the copy (seqlock validation).
+ *          Consumed items are not destroyed, they are overwritten when
+ *          their slot is reused.
+ *
+ * @note push(), try_push(), try_emplace() and subscribe() must be called
+ *       from the producer thread. read(), consume(), available(), missed()
+ *       and unsubscribe() must be called from the thread owning the reader.
+ *
+ * @see https://lmax-exchange.github.io/disruptor/disruptor.html
+ *
+ * @tparam T Elements type.
+ * @tparam Allocator Allocator.
+ */
+template<std::movable T, typename Allocator = std::allocator<T>>
+  requires std::default_initializable<T>
+class broadcast
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using reader_id = std::size_t;
+    using const_segments = typename cqueue<T, Allocator>::const_segments;
+
+  private: // static members
+
+    //! Cache line size (avoid false sharing between cursors).
+    static constexpr std::size_t CACHE_LINE = 64;
+    //! Default maximum number of readers.
+    static constexpr size_type DEFAULT_MAX_READERS = 16;
+
+  private: // declarations
+
+    //! Reader state (one cache line per reader).
+    struct alignas(CACHE_LINE) reader {
+      //! Sequence number of the next item to read (written by reader).
+      std::atomic<std::uint64_t> cursor = 0;
+      //! Subscribed flag.
+      std::atomic<bool> active = false;
+      //! Number of overwritten items not read (reader only).
+      std::uint64_t missed = 0;
+    };
+
+  private: // members
+
+    //! Slots storage (full and linearized).
+    cqueue<T, Allocator> mSlots;
+    //! Ring slots.
+    std::span<T> mRing{};
+    //! Ring size minus one.
+    std::uint64_t mMask = 0;
+    //! Reader slots (unsubscribed ones are reused).
+    std::unique_ptr<reader[]> mReaders;
+    //! Number of reader slots.
+    size_type mMaxReaders = 0;
+    //! Full ring behavior.
+    broadcast_mode mMode = broadcast_mode::block;
+    //! Sequence number of the next item to publish (written by producer).
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> mPublished = 0;
+    //! Sequence number following the item being written (overwrite mode).
+    std::atomic<std::uint64_t> mClaimed = 0;
+    //! Slowest reader cursor seen by the producer (producer only).
+    alignas(CACHE_LINE) std::uint64_t mGate = 0;
+
+  private: // methods
+
+    //! Return the reader state (throw exception if not subscribed).
+    reader & getReader(reader_id id) const;
+    //! Slowest subscribed reader cursor (seq if none).
+    std::uint64_t getSlowest(std::uint64_t seq) const noexcept;
+    //! Items [seq, seq + n) as ring segments.
+    const_segments getSegments(std::uint64_t seq, size_type n) const noexcept;
+    //! Skip the items overwritten before being read (return reader cursor).
+    std::uint64_t skipLapped(reader &r, std::uint64_t published) noexcept;
+    //! Copy an item using relaxed atomic byte accesses (overwrite mode).
+    static void copyAtomic(T &dest, const T &src) noexcept;
+
+  public: // methods
+
+    //! Constructor (capacity rounded up to a power of 2).
+    explicit broadcast(size_type capacity, broadcast_mode mode = broadcast_mode::block, size_type max_readers = DEFAULT_MAX_READERS, const Allocator &alloc = Allocator());
+    //! Non-copyable.
+    broadcast(const broadcast &) = delete;
+    //! Non-copyable.
+    broadcast & operator=(const broadcast &) = delete;
+    //! Destructor.
+    ~broadcast() = default;
+
+    //! Return ring capacity.
+    size_type capacity() const noexcept { return mRing.size(); }
+    //! Full ring behavior.
+    broadcast_mode mode() const noexcept { return mMode; }
+    //! Sequence number of the next pushed item.
+    std::uint64_t sequence() const noexcept { return mPublished.load(std::memory_order_acquire); }
+    //! Number of subscribed readers.
+    size_type readers() const noexcept;
+
+    //! Add a reader starting at the next pushed item (producer thread).
+    reader_id subscribe();
+    //! Remove a reader.
+    void unsubscribe(reader_id id);
+
+    //! Construct and publish an item (false if gated).
+    template <class... Args>
+    bool try_emplace(Args&&... args);
+    //! Publish an item (false if gated).
+    bool try_push(const T &val) { return try_emplace(val); }
+    //! Publish an item (false if gated).
+    bool try_push(T &&val) { return try_emplace(std::move(val)); }
+    //! Publish an item (waits while gated).
+    void push(const T &val);
+    //! Publish an item (waits while gated).
+    void push(T &&val);
+
+    //! Number of published items not read by the reader.
+    size_type available(reader_id id) const;
+    //! Number of items overwritten before being read by the reader.
+    std::uint64_t missed(reader_id id) const { return getReader(id).missed; }
+    //! Return up to n published items not read by the reader (block mode).
+    const_segments read(reader_id id, size_type n = std::numeric_limits<size_type>::max());
+    //! Copy up to dest.size() published items not read by the reader.
+    size_type read(reader_id id, std::span<T> dest) requires std::is_trivially_copyable_v<T>;
+    //! Advance the reader cursor n items (false if they were overwritten while read).
+    bool consume(reader_id id, size_type n);
+};
+
+} // namespace gto
+
+/**
+ * @param[in] capacity Number of slots (rounded up to a power of 2).
+ * @param[in] mode Full ring behavior.
+ * @param[in] max_readers Maximum number of subscribed readers.
+ * @param[in] alloc Allocator to use.
+ * @exception std::length_error Invalid capacity.
+ * @exception std::invalid_argument Overwrite mode with non trivially copyable type.
+ * @exception std::bad_alloc Memory allocation failed.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+gto::broadcast<T, Allocator>::broadcast(size_type capacity, broadcast_mode mode, size_type max_readers, const Allocator &alloc) :
+  mSlots(0, alloc), mReaders(new reader[max_readers]), mMaxReaders(max_readers), mMode(mode)
+{
+  if (capacity == 0 || capacity > std::numeric_limits<size_type>::max() / 2) {
+    CQUEUE_THROW(std::length_error("broadcast invalid capacity"));
+  }
+  if (mode == broadcast_mode::overwrite && !std::is_trivially_copyable_v<T>) {
+    CQUEUE_THROW(std::invalid_argument("broadcast overwrite mode requires a trivially copyable type"));
+  }
+
+  size_type size = 1;
+  while (size < capacity) {
+    size *= 2;
+  }
+  mSlots.reserve(size);
+  for (size_type i = 0; i < size; ++i) {
+    mSlots.emplace_back();
+  }
+  mRing = mSlots.linearize();
+  mMask = size - 1;
+}
+
+/**
+ * @param[in] id Reader identifier.
+ * @return Reader state.
+ * @exception std::out_of_range Reader not subscribed.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::broadcast<T, Allocator>::getReader(reader_id id) const -> reader & {
+  if (id >= mMaxReaders || !mReaders[id].active.load(std::memory_order_relaxed)) {
+    CQUEUE_THROW(std::out_of_range("broadcast reader not subscribed"));
+  }
+  return mReaders[id];
+}
+
+/**
+ * @details Acquire loads pair with the release store in consume(), so the
+ *          readers are done with the slots before the producer reuses them.
+ * @param[in] seq Sequence number of the next item to publish.
+ * @return Minimum cursor of the subscribed readers.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+std::uint64_t gto::broadcast<T, Allocator>::getSlowest(std::uint64_t seq) const noexcept {
+  std::uint64_t ret = seq;
+  for (size_type i = 0; i < mMaxReaders; ++i) {
+    if (mReaders[i].active.load(std::memory_order_acquire)) {
+      ret = std::min(ret, mReaders[i].cursor.load(std::memory_order_acquire));
+    }
+  }
+  return ret;
+}
+
+/**
+ * @param[in] seq Sequence number of the first item.
+ * @param[in] n Number of items (not greater than capacity).
+ * @return Items in order (second segment empty when not wrapped).
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::broadcast<T, Allocator>::getSegments(std::uint64_t seq, size_type n) const noexcept -> const_segments {
+  auto pos = static_cast<size_type>(seq & mMask);
+  size_type len1 = std::min(n, mRing.size() - pos);
+  return {std::span<const T>(mRing.data() + pos, len1), std::span<const T>(mRing.data(), n - len1)};
+}
+
+/**
+ * @details A reader lapped by the producer (overwrite mode) skips the
+ *          overwritten items (see missed()).
+ * @param[in] r Reader state.
+ * @param[in] published Published sequence number.
+ * @return Sequence number of the next item to read.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+std::uint64_t gto::broadcast<T, Allocator>::skipLapped(reader &r, std::uint64_t published) noexcept {
+  std::uint64_t cursor = r.cursor.load(std::memory_order_relaxed);
+  if (published - cursor > mRing.size()) {
+    r.missed += published - cursor - mRing.size();
+    cursor = published - mRing.size();
+    r.cursor.store(cursor, std::memory_order_release);
+  }
+  return cursor;
+}
+
+/**
+ * @details A slot can be rewritten by the producer while a reader copies
+ *          it, so both sides access its bytes atomically (no data race).
+ *          The copy can be torn, it is validated later by consume().
+ * @param[out] dest Destination item.
+ * @param[in] src Source item.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+void gto::broadcast<T, Allocator>::copyAtomic(T &dest, const T &src) noexcept {
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    auto *to = reinterpret_cast<unsigned char *>(std::addressof(dest));
+    auto *from = reinterpret_cast<unsigned char *>(const_cast<T *>(std::addressof(src)));
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      std::atomic_ref<unsigned char>(to[i]).store(std::atomic_ref<unsigned char>(from[i]).load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+}
+
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::broadcast<T, Allocator>::readers() const noexcept -> size_type {
+  size_type ret = 0;
+  for (size_type i = 0; i < mMaxReaders; ++i) {
+    ret += (mReaders[i].active.load(std::memory_order_relaxed) ? 1U : 0U);
+  }
+  return ret;
+}
+
+/**
+ * @details Called from the producer thread, so the new reader gates the
+ *          next push. Unsubscribed identifiers are reused.
+ * @return Reader identifier.
+ * @exception std::length_error Maximum number of readers reached.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::broadcast<T, Allocator>::subscribe() -> reader_id {
+  for (size_type i = 0; i < mMaxReaders; ++i) {
+    reader &r = mReaders[i];
+    if (!r.active.load(std::memory_order_acquire)) {
+      r.cursor.store(mPublished.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      r.missed = 0;
+      r.active.store(true, std::memory_order_release);
+      return i;
+    }
+  }
+  CQUEUE_THROW(std::length_error("broadcast max readers reached"));
+}
+
+/**
+ * @details Items pending to be read by this reader no longer gate the producer.
+ * @param[in] id Reader identifier.
+ * @exception std::out_of_range Reader not subscribed.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+void gto::broadcast<T, Allocator>::unsubscribe(reader_id id) {
+  getReader(id).active.store(false, std::memory_order_release);
+}
+
+/**
+ * @details In block mode the slowest cursor is cached, and only reloaded
+ *          when the cached one gates the producer. In overwrite mode the
+ *          slot is claimed before being written, so that readers can
+ *          detect that a batch was rewritten while it was read.
+ * @param[in] args Arguments of the new item.
+ * @return true if published, false if gated by the slowest reader.
+ * @exception ... Error throwed by constructor or move assignment.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+template <class... Args>
+bool gto::broadcast<T, Allocator>::try_emplace(Args&&... args) {
+  std::uint64_t seq = mPublished.load(std::memory_order_relaxed);
+
+  if (mMode == broadcast_mode::block && seq - mGate > mMask) {
+    mGate = getSlowest(seq);
+    if (seq - mGate > mMask) {
+      return false;
+    }
+  }
+
+  T val(std::forward<Args>(args)...);
+  if (mMode == broadcast_mode::overwrite) {
+    mClaimed.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    copyAtomic(mRing[static_cast<size_type>(seq & mMask)], val);
+  }
+  else {
+    mRing[static_cast<size_type>(seq & mMask)] = std::move(val);
+  }
+  mPublished.store(seq + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @param[in] val Value to add.
+ * @exception ... Error throwed by copy constructor or move assignment.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+void gto::broadcast<T, Allocator>::push(const T &val) {
+  while (!try_emplace(val)) {
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * @param[in] val Value to add (moved only when published).
+ * @exception ... Error throwed by move constructor or move assignment.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+void gto::broadcast<T, Allocator>::push(T &&val) {
+  while (!try_emplace(std::move(val))) {
+    std::this_thread::yield();
+  }
+}
+
+/**
+ * @param[in] id Reader identifier.
+ * @return Number of items pending to read (may exceed capacity in overwrite mode).
+ * @exception std::out_of_range Reader not subscribed.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::broadcast<T, Allocator>::available(reader_id id) const -> size_type {
+  const reader &r = getReader(id);
+  return static_cast<size_type>(mPublished.load(std::memory_order_acquire) - r.cursor.load(std::memory_order_relaxed));
+}
+
+/**
+ * @details Items are accessed in place (no copies), they are valid until
+ *          consume(). Not available in overwrite mode, where the producer
+ *          can rewrite the slots while they are used (data race).
+ * @param[in] id Reader identifier.
+ * @param[in] n Maximum number of items.
+ * @return Items in order (second segment empty when not wrapped).
+ * @exception std::out_of_range Reader not subscribed.
+ * @exception std::logic_error Overwrite mode.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::broadcast<T, Allocator>::read(reader_id id, size_type n) -> const_segments {
+  reader &r = getReader(id);
+  if (mMode == broadcast_mode::overwrite) {
+    CQUEUE_THROW(std::logic_error("broadcast in-place read in overwrite mode"));
+  }
+  std::uint64_t published = mPublished.load(std::memory_order_acquire);
+  std::uint64_t cursor = skipLapped(r, published);
+  n = static_cast<size_type>(std::min(static_cast<std::uint64_t>(n), published - cursor));
+  return getSegments(cursor, n);
+}
+
+/**
+ * @details Items are copied with relaxed atomic byte loads. In overwrite
+ *          mode the copies can be torn: dest must not be used until
+ *          consume() returns true. A reader lapped by the producer first
+ *          skips the overwritten items (see missed()).
+ * @param[in] id Reader identifier.
+ * @param[out] dest Destination of the items.
+ * @return Number of items copied.
+ * @exception std::out_of_range Reader not subscribed.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::broadcast<T, Allocator>::read(reader_id id, std::span<T> dest) -> size_type
+  requires std::is_trivially_copyable_v<T>
+{
+  reader &r = getReader(id);
+  std::uint64_t published = mPublished.load(std::memory_order_acquire);
+  std::uint64_t cursor = skipLapped(r, published);
+  auto n = static_cast<size_type>(std::min(static_cast<std::uint64_t>(dest.size()), published - cursor));
+  for (size_type i = 0; i < n; ++i) {
+    copyAtomic(dest[i], mRing[static_cast<size_type>((cursor + i) & mMask)]);
+  }
+  return n;
+}
+
+/**
+ * @details The release store tells the producer that the slots can be
+ *          reused. In overwrite mode the items read are validated against
+ *          the last claimed slot (seqlock); if some of them were rewritten
+ *          during the read, the whole batch is counted as missed.
+ * @param[in] id Reader identifier.
+ * @param[in] n Number of items (limited to available ones).
+ * @return true if the items read were valid, false if they must be discarded.
+ * @exception std::out_of_range Reader not subscribed.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+bool gto::broadcast<T, Allocator>::consume(reader_id id, size_type n) {
+  reader &r = getReader(id);
+  std::uint64_t published = mPublished.load(std::memory_order_acquire);
+  std::uint64_t cursor = r.cursor.load(std::memory_order_relaxed);
+  std::uint64_t count = std::min(static_cast<std::uint64_t>(n), published - cursor);
+  bool ret = true;
+
+  if (mMode == broadcast_mode::overwrite) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (mClaimed.load(std::memory_order_relaxed) > cursor + mRing.size()) {
+      r.missed += count;
+      ret = false;
+    }
+  }
+
+  r.cursor.store(cursor + count, std::memory_order_release);
+  return ret;
+}
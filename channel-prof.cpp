@@ -0,0 +1,119 @@
+#include "cqueue.hpp"
+#include "channel.hpp"
+
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <iostream>
+#include <condition_variable>
+
+#define NUM_ROUND_TRIPS 1'000'000
+#define NUM_MESSAGES 10'000'000
+#define CAPACITY 64
+
+// g++ -std=c++20 -O3 -pthread -o channel-prof channel-prof.cpp
+// Hand-off latency of async_channel on a single-threaded executor (ping-pong
+// between two coroutines) and streaming throughput with a bounded buffer.
+// Baseline: ping-pong between two threads using mutex+condvar cqueues.
+
+using namespace gto;
+
+async_task ping(async_channel<std::uint64_t> &out, async_channel<std::uint64_t> &in) {
+  for (std::uint64_t i = 0; i < NUM_ROUND_TRIPS; i++) {
+    co_await out.push(i);
+    co_await in.pop();
+  }
+}
+
+async_task pong(async_channel<std::uint64_t> &in, async_channel<std::uint64_t> &out) {
+  for (std::uint64_t i = 0; i < NUM_ROUND_TRIPS; i++) {
+    auto val = co_await in.pop();
+    co_await out.push(*val);
+  }
+}
+
+async_task stream_producer(async_channel<std::uint64_t> &ch) {
+  for (std::uint64_t i = 0; i < NUM_MESSAGES; i++) {
+    co_await ch.push(i);
+  }
+}
+
+async_task stream_consumer(async_channel<std::uint64_t> &ch, std::uint64_t &sum) {
+  for (std::uint64_t i = 0; i < NUM_MESSAGES; i++) {
+    sum += *(co_await ch.pop());
+  }
+}
+
+//! Blocking queue (mutex + condvar).
+class blocking_queue
+{
+  private:
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    cqueue<std::uint64_t> mQueue;
+  public:
+    blocking_queue() : mMutex(), mCond(), mQueue() {}
+    void push(std::uint64_t val) {
+      { std::lock_guard lock(mMutex); mQueue.push(val); }
+      mCond.notify_one();
+    }
+    std::uint64_t pop() {
+      std::unique_lock lock(mMutex);
+      mCond.wait(lock, [this]() { return !mQueue.empty(); });
+      return mQueue.pop();
+    }
+};
+
+void run_pingpong_coroutines() {
+  async_executor executor;
+  async_channel<std::uint64_t> ch1(executor, 1);
+  async_channel<std::uint64_t> ch2(executor, 1);
+  executor.spawn(ping(ch1, ch2));
+  executor.spawn(pong(ch1, ch2));
+  executor.run();
+}
+
+void run_stream_coroutines() {
+  async_executor executor;
+  async_channel<std::uint64_t> ch(executor, CAPACITY);
+  std::uint64_t sum = 0;
+  executor.spawn(stream_producer(ch));
+  executor.spawn(stream_consumer(ch, sum));
+  executor.run();
+  if (sum != static_cast<std::uint64_t>(NUM_MESSAGES) * (NUM_MESSAGES - 1) / 2) {
+    std::cerr << "error: wrong result" << std::endl;
+  }
+}
+
+void run_pingpong_threads() {
+  blocking_queue q1;
+  blocking_queue q2;
+  std::thread t([&]() {
+    for (std::uint64_t i = 0; i < NUM_ROUND_TRIPS; i++) {
+      q2.push(q1.pop());
+    }
+  });
+  for (std::uint64_t i = 0; i < NUM_ROUND_TRIPS; i++) {
+    q1.push(i);
+    q2.pop();
+  }
+  t.join();
+}
+
+template<typename Fn>
+void measure(const char *name, std::uint64_t handoffs, Fn fn) {
+  auto t1 = std::chrono::steady_clock::now();
+  fn();
+  auto t2 = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+  std::cout
+      << name << " elapsed time in microseconds : " << ns / 1000 << " µs ("
+      << static_cast<double>(ns) / static_cast<double>(handoffs) << " ns/hand-off)\n";
+}
+
+int main() {
+  measure("coroutines ping-pong", 2ULL * NUM_ROUND_TRIPS, run_pingpong_coroutines);
+  measure("coroutines stream", NUM_MESSAGES, run_stream_coroutines);
+  measure("threads ping-pong (mutex+condvar)", 2ULL * NUM_ROUND_TRIPS, run_pingpong_threads);
+}
@@ -0,0 +1,175 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "catch.hpp"
+#include "channel.hpp"
+
+using gto::async_task;
+using gto::async_channel;
+using gto::async_executor;
+
+namespace {
+
+async_task producer(async_channel<int> &ch, int from, int to, std::vector<std::string> &log) {
+  for (int i = from; i < to; i++) {
+    log.push_back("push " + std::to_string(i));
+    bool ok = co_await ch.push(i);
+    if (!ok) {
+      log.push_back("closed");
+      co_return;
+    }
+  }
+}
+
+async_task consumer(async_channel<int> &ch, int n, std::vector<int> &values) {
+  for (int i = 0; i < n; i++) {
+    auto val = co_await ch.pop();
+    if (!val) {
+      values.push_back(-1);
+      co_return;
+    }
+    values.push_back(*val);
+  }
+}
+
+async_task move_only_consumer(async_channel<std::unique_ptr<int>> &ch, int &sum) {
+  while (auto val = co_await ch.pop()) {
+    sum += **val;
+  }
+}
+
+async_task move_only_producer(async_channel<std::unique_ptr<int>> &ch) {
+  for (int i = 1; i <= 4; i++) {
+    co_await ch.push(std::make_unique<int>(i));
+  }
+  ch.close();
+}
+
+} // unnamed namespace
+
+TEST_CASE("async_channel") {
+
+  SECTION("executor") {
+    async_executor executor;
+    CHECK(!executor.run_one());
+    CHECK(executor.run() == 0);
+    std::vector<int> values;
+    async_channel<int> ch(executor);
+    // not spawned tasks are destroyed
+    { auto task = consumer(ch, 1, values); }
+    executor.spawn(consumer(ch, 1, values));
+    CHECK(executor.size() == 1);
+    CHECK(executor.run() == 1);
+    CHECK(values.empty());
+    ch.close();
+    CHECK(executor.run() == 1);
+    CHECK(values == std::vector<int>{-1});
+  }
+
+  SECTION("buffered") {
+    async_executor executor;
+    async_channel<int> ch(executor, 4);
+    std::vector<std::string> log;
+    std::vector<int> values;
+    executor.spawn(producer(ch, 0, 3, log));
+    executor.run();
+    // no suspension, all buffered
+    CHECK(ch.size() == 3);
+    executor.spawn(consumer(ch, 3, values));
+    executor.run();
+    CHECK(values == std::vector<int>{0, 1, 2});
+    CHECK(ch.empty());
+  }
+
+  SECTION("consumer waiting") {
+    async_executor executor;
+    async_channel<int> ch(executor, 4);
+    std::vector<std::string> log;
+    std::vector<int> values;
+    executor.spawn(consumer(ch, 2, values));
+    executor.run();
+    CHECK(values.empty());
+    executor.spawn(producer(ch, 10, 12, log));
+    executor.run();
+    CHECK(values == std::vector<int>{10, 11});
+    CHECK(ch.empty());
+  }
+
+  SECTION("backpressure") {
+    async_executor executor;
+    async_channel<int> ch(executor, 2);
+    CHECK(ch.capacity() == 2);
+    std::vector<std::string> log;
+    std::vector<int> values;
+    executor.spawn(producer(ch, 0, 5, log));
+    executor.run();
+    // producer suspended on third push
+    CHECK(ch.size() == 2);
+    CHECK(log.size() == 3);
+    executor.spawn(consumer(ch, 5, values));
+    executor.run();
+    CHECK(values == std::vector<int>{0, 1, 2, 3, 4});
+    CHECK(log.size() == 5);
+    CHECK(ch.empty());
+  }
+
+  SECTION("close") {
+    async_executor executor;
+    async_channel<int> ch(executor, 1);
+    std::vector<std::string> log;
+    std::vector<int> values1;
+    std::vector<int> values2;
+    executor.spawn(producer(ch, 0, 3, log));
+    executor.run();
+    CHECK(log.back() == "push 1");
+    ch.close();
+    CHECK(ch.closed());
+    executor.run();
+    CHECK(log.back() == "closed");
+    // buffered value still available
+    executor.spawn(consumer(ch, 3, values1));
+    executor.run();
+    CHECK(values1 == std::vector<int>{0, -1});
+    // suspended popper is woken up
+    async_channel<int> ch2(executor);
+    executor.spawn(consumer(ch2, 1, values2));
+    executor.run();
+    CHECK(values2.empty());
+    ch2.close();
+    executor.run();
+    CHECK(values2 == std::vector<int>{-1});
+  }
+
+  SECTION("move-only") {
+    async_executor executor;
+    async_channel<std::unique_ptr<int>> ch(executor, 1);
+    int sum = 0;
+    executor.spawn(move_only_consumer(ch, sum));
+    executor.spawn(move_only_producer(ch));
+    executor.run();
+    CHECK(sum == 10);
+  }
+
+  SECTION("many-to-many") {
+    async_executor executor;
+    async_channel<int> ch(executor, 3);
+    std::vector<std::string> log;
+    std::vector<int> values1;
+    std::vector<int> values2;
+    executor.spawn(consumer(ch, 50, values1));
+    executor.spawn(producer(ch, 0, 50, log));
+    executor.spawn(consumer(ch, 50, values2));
+    executor.spawn(producer(ch, 50, 100, log));
+    executor.run();
+    CHECK(values1.size() + values2.size() == 100);
+    std::vector<int> all(values1);
+    all.insert(all.end(), values2.begin(), values2.end());
+    std::sort(all.begin(), all.end());
+    for (int i = 0; i < 100; i++) {
+      REQUIRE(all[static_cast<std::size_t>(i)] == i);
+    }
+    CHECK(ch.empty());
+  }
+
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <coroutine>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Fire-and-forget coroutine run by an async_executor.
+ *
+ * @details The coroutine starts suspended and is destroyed when it
+ *          finishes. Pass it to async_executor::spawn().
+ */
+class async_task
+{
+  public: // declarations
+
+    //! Coroutine promise.
+    struct promise_type {
+      async_task get_return_object() noexcept { return async_task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() noexcept {}
+      void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+  private: // members
+
+    //! Coroutine handle (owned until spawned).
+    std::coroutine_handle<promise_type> mHandle{};
+
+  public: // methods
+
+    //! Constructor.
+    explicit async_task(std::coroutine_handle<promise_type> handle) noexcept : mHandle{handle} {}
+    //! Move constructor.
+    async_task(async_task &&other) noexcept : mHandle{std::exchange(other.mHandle, {})} {}
+    //! Non-copyable.
+    async_task(const async_task &) = delete;
+    //! Non-assignable.
+    async_task & operator=(const async_task &) = delete;
+    //! Non-assignable.
+    async_task & operator=(async_task &&) = delete;
+    //! Destructor (destroys a not spawned coroutine).
+    ~async_task() { if (mHandle) mHandle.destroy(); }
+
+    //! Release the coroutine handle.
+    std::coroutine_handle<> release() noexcept { return std::exchange(mHandle, {}); }
+};
+
+/**
+ * @brief Single-threaded executor.
+ *
+ * @details Resumes ready coroutines in FIFO order from the thread calling
+ *          run(). Ready coroutines are kept in a cqueue.
+ *
+ * @note Coroutines not finished when the executor is destroyed are leaked.
+ */
+class async_executor
+{
+  private: // members
+
+    //! Coroutines ready to be resumed.
+    cqueue<std::coroutine_handle<>> mReady{};
+
+  public: // methods
+
+    //! Schedule a coroutine.
+    void post(std::coroutine_handle<> handle) { mReady.push_back(handle); }
+    //! Schedule a new coroutine.
+    void spawn(async_task task) { post(task.release()); }
+    //! Resume the next ready coroutine (false if none).
+    bool run_one();
+    //! Resume coroutines until there are no ready ones.
+    std::size_t run();
+    //! Number of ready coroutines.
+    std::size_t size() const noexcept { return mReady.size(); }
+};
+
+/**
+ * @brief Coroutine channel buffered by a cqueue.
+ *
+ * @details Coroutines exchange values with co_await ch.push(val) and
+ *          co_await ch.pop(), suspending instead of blocking a thread.
+ *          When the buffer is full (capacity reached) pushers suspend
+ *          until a popper makes room (backpressure). When it is empty
+ *          poppers suspend until a value is pushed.
+ *          A push or pop waking a suspended coroutine hands off the value
+ *          and resumes it directly (symmetric transfer); the waker is
+ *          posted to the executor and continues later.
+ *          Once closed, pushes fail and pops return the buffered values
+ *          and then nullopt.
+ *
+ * @note This class is not thread-safe. All coroutines using the channel
+ *       must be run by the same executor.
+ *
+ * @tparam T Elements type.
+ * @tparam Allocator Allocator.
+ */
+template<std::movable T, typename Allocator = std::allocator<T>>
+class async_channel
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+    //! Awaitable returned by push() (co_await returns false if closed).
+    class push_awaiter
+    {
+      friend class async_channel;
+      private:
+        async_channel &mChannel;
+        T mValue;
+        std::coroutine_handle<> mHandle{};
+        bool mDone = false;
+      public:
+        push_awaiter(async_channel &channel, T &&val) : mChannel{channel}, mValue{std::move(val)} {}
+        bool await_ready();
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> handle);
+        bool await_resume() const noexcept { return mDone; }
+    };
+
+    //! Awaitable returned by pop() (co_await returns nullopt if closed).
+    class pop_awaiter
+    {
+      friend class async_channel;
+      private:
+        async_channel &mChannel;
+        std::optional<T> mValue{};
+        std::coroutine_handle<> mHandle{};
+      public:
+        explicit pop_awaiter(async_channel &channel) : mChannel{channel} {}
+        bool await_ready();
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> handle);
+        std::optional<T> await_resume() { return std::move(mValue); }
+    };
+
+  private: // members
+
+    //! Executor running the coroutines.
+    async_executor &mExecutor;
+    //! Buffered values.
+    cqueue<T, Allocator> mBuffer;
+    //! Suspended pushers (buffer full).
+    cqueue<push_awaiter *> mPushers{};
+    //! Suspended poppers (buffer empty).
+    cqueue<pop_awaiter *> mPoppers{};
+    //! Closed flag.
+    bool mClosed = false;
+
+  public: // methods
+
+    //! Constructor (capacity=0 means unlimited).
+    explicit async_channel(async_executor &executor, size_type capacity = 0, const Allocator &alloc = Allocator()) :
+      mExecutor{executor}, mBuffer(capacity, alloc) {}
+    //! Non-copyable.
+    async_channel(const async_channel &) = delete;
+    //! Non-assignable.
+    async_channel & operator=(const async_channel &) = delete;
+
+    //! Return channel capacity.
+    size_type capacity() const noexcept { return mBuffer.capacity(); }
+    //! Number of buffered values.
+    size_type size() const noexcept { return mBuffer.size(); }
+    //! Check if there are buffered values.
+    [[nodiscard]] bool empty() const noexcept { return mBuffer.empty(); }
+    //! Check if channel is closed.
+    bool closed() const noexcept { return mClosed; }
+
+    //! Send a value (co_await it).
+    [[nodiscard]] push_awaiter push(T val) { return push_awaiter{*this, std::move(val)}; }
+    //! Receive a value (co_await it).
+    [[nodiscard]] pop_awaiter pop() { return pop_awaiter{*this}; }
+    //! Close the channel and wake up the suspended coroutines.
+    void close();
+};
+
+} // namespace gto
+
+/**
+ * @return true = a coroutine was resumed, false = no ready coroutines.
+ */
+inline bool gto::async_executor::run_one() {
+  if (mReady.empty()) {
+    return false;
+  }
+  mReady.pop_front().resume();
+  return true;
+}
+
+/**
+ * @return Number of resumed coroutines.
+ */
+inline std::size_t gto::async_executor::run() {
+  std::size_t ret = 0;
+  while (run_one()) {
+    ++ret;
+  }
+  return ret;
+}
+
+/**
+ * @details Completes without suspending when the value fits in the buffer
+ *          and no popper is waiting, or when the channel is closed.
+ */
+template<std::movable T, typename Allocator>
+bool gto::async_channel<T, Allocator>::push_awaiter::await_ready() {
+  if (mChannel.mClosed) {
+    return true;
+  }
+  if (mChannel.mPoppers.empty() && !mChannel.mBuffer.full()) {
+    mChannel.mBuffer.push_back(std::move(mValue));
+    mDone = true;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @param[in] handle Pushing coroutine.
+ * @return Coroutine to resume (waiting popper or back to executor).
+ */
+template<std::movable T, typename Allocator>
+std::coroutine_handle<> gto::async_channel<T, Allocator>::push_awaiter::await_suspend(std::coroutine_handle<> handle) {
+  mHandle = handle;
+  if (!mChannel.mPoppers.empty()) {
+    // hand off to the waiting popper
+    pop_awaiter *popper = mChannel.mPoppers.pop_front();
+    popper->mValue.emplace(std::move(mValue));
+    mDone = true;
+    mChannel.mExecutor.post(handle);
+    return popper->mHandle;
+  }
+  mChannel.mPushers.push_back(this);
+  return std::noop_coroutine();
+}
+
+/**
+ * @details Completes without suspending when a value is buffered and no
+ *          pusher is waiting, or when the channel is empty and closed.
+ */
+template<std::movable T, typename Allocator>
+bool gto::async_channel<T, Allocator>::pop_awaiter::await_ready() {
+  if (!mChannel.mBuffer.empty() && mChannel.mPushers.empty()) {
+    mValue.emplace(mChannel.mBuffer.pop_front());
+    return true;
+  }
+  return (mChannel.mBuffer.empty() && mChannel.mClosed);
+}
+
+/**
+ * @param[in] handle Popping coroutine.
+ * @return Coroutine to resume (waiting pusher or back to executor).
+ */
+template<std::movable T, typename Allocator>
+std::coroutine_handle<> gto::async_channel<T, Allocator>::pop_awaiter::await_suspend(std::coroutine_handle<> handle) {
+  mHandle = handle;
+  if (!mChannel.mBuffer.empty()) {
+    // make room for the waiting pusher
+    push_awaiter *pusher = mChannel.mPushers.pop_front();
+    mValue.emplace(mChannel.mBuffer.pop_front());
+    mChannel.mBuffer.push_back(std::move(pusher->mValue));
+    pusher->mDone = true;
+    mChannel.mExecutor.post(handle);
+    return pusher->mHandle;
+  }
+  mChannel.mPoppers.push_back(this);
+  return std::noop_coroutine();
+}
+
+/**
+ * @details Suspended pushers resume returning false; suspended poppers
+ *          resume returning nullopt (there are no buffered values).
+ *          Values buffered before closing can still be popped.
+ */
+template<std::movable T, typename Allocator>
+void gto::async_channel<T, Allocator>::close() {
+  mClosed = true;
+  mPushers.drain([this](push_awaiter *pusher) { mExecutor.post(pusher->mHandle); });
+  mPoppers.drain([this](pop_awaiter *popper) { mExecutor.post(popper->mHandle); });
+}
@@ -96,7 +96,7 @@ void example5() {
   queue.pop();
   queue.push(99);
   std::cout << prefix << to_string(queue) << std::endl;
-  std::sort(queue.begin(), queue.end());
+  gto::sort(queue);
   std::cout << prefix << to_string(queue) << std::endl;
 }
 
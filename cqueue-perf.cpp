@@ -0,0 +1,441 @@
+#include "cqueue.hpp"
+
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <string_view>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// g++ -std=c++20 -O3 -o cqueue-perf cqueue-perf.cpp
+// ./cqueue-perf [scenario ...]
+// Hardware counters require perf_event_paranoid <= 2 (see /proc/sys/kernel/perf_event_paranoid).
+// When they are unavailable (containers, VMs) only the elapsed time is reported.
+
+using namespace gto;
+
+/**
+ * @brief Hardware performance counters of the calling thread (perf_event_open).
+ * @details Counters are opened as a single group (first available one is
+ *          the leader), so they are scheduled on the PMU together and
+ *          measure the same interval. If the group is multiplexed with
+ *          other events, values are scaled by time_enabled/time_running.
+ *          Counters that can not be opened are reported as unavailable.
+ */
+class perf_counters
+{
+  public: // declarations
+
+    enum counter : std::size_t { INSTRUCTIONS, CYCLES, BRANCH_MISSES, L1D_MISSES, LLC_MISSES, NUM_COUNTERS };
+
+    //! Counter values (-1 = unavailable).
+    using values = std::array<double, NUM_COUNTERS>;
+
+  private: // declarations
+
+    //! Group read layout (PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING | ID).
+    struct group_data {
+      std::uint64_t nr;
+      std::uint64_t time_enabled;
+      std::uint64_t time_running;
+      struct { std::uint64_t value; std::uint64_t id; } values[NUM_COUNTERS];
+    };
+
+  private: // members
+
+    //! Counter file descriptors (-1 = unavailable).
+    std::array<int, NUM_COUNTERS> mFds{};
+    //! Counter ids (used to match group read values).
+    std::array<std::uint64_t, NUM_COUNTERS> mIds{};
+    //! Group leader file descriptor (-1 = none).
+    int mLeader = -1;
+
+  private: // methods
+
+    static int open(std::uint32_t type, std::uint64_t config, int group) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = (group < 0);
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING | PERF_FORMAT_ID;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+
+    static constexpr std::uint64_t cache(std::uint64_t id) {
+      return (id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    }
+
+    void ioctlGroup(unsigned long request) {
+      if (mLeader >= 0) ioctl(mLeader, request, PERF_IOC_FLAG_GROUP);
+    }
+
+  public: // methods
+
+    perf_counters() {
+      const std::array<std::pair<std::uint32_t, std::uint64_t>, NUM_COUNTERS> events = {{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL)}
+      }};
+      for (std::size_t i = 0; i < NUM_COUNTERS; ++i) {
+        mFds[i] = open(events[i].first, events[i].second, mLeader);
+        if (mFds[i] < 0) continue;
+        if (ioctl(mFds[i], PERF_EVENT_IOC_ID, &mIds[i]) < 0) {
+          close(mFds[i]);
+          mFds[i] = -1;
+          continue;
+        }
+        if (mLeader < 0) mLeader = mFds[i];
+      }
+    }
+    perf_counters(const perf_counters &) = delete;
+    perf_counters & operator=(const perf_counters &) = delete;
+    ~perf_counters() {
+      // members before leader
+      for (int fd : mFds) {
+        if (fd >= 0 && fd != mLeader) close(fd);
+      }
+      if (mLeader >= 0) close(mLeader);
+    }
+
+    //! Check if at least one counter is available.
+    bool available() const { return (mLeader >= 0); }
+
+    //! Reset and start counting.
+    void start() {
+      ioctlGroup(PERF_EVENT_IOC_RESET);
+      ioctlGroup(PERF_EVENT_IOC_ENABLE);
+    }
+
+    //! Suspend counting (values preserved).
+    void pause() { ioctlGroup(PERF_EVENT_IOC_DISABLE); }
+
+    //! Resume counting.
+    void resume() { ioctlGroup(PERF_EVENT_IOC_ENABLE); }
+
+    //! Stop counting and return counter values (scaled if multiplexed).
+    values stop() {
+      values ret;
+      ret.fill(-1.0);
+      if (mLeader < 0) return ret;
+      ioctlGroup(PERF_EVENT_IOC_DISABLE);
+      group_data data{};
+      if (read(mLeader, &data, sizeof(data)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t)) || data.time_running == 0) {
+        return ret;
+      }
+      double scale = static_cast<double>(data.time_enabled) / static_cast<double>(data.time_running);
+      for (std::size_t j = 0; j < data.nr && j < NUM_COUNTERS; ++j) {
+        for (std::size_t i = 0; i < NUM_COUNTERS; ++i) {
+          if (mFds[i] >= 0 && mIds[i] == data.values[j].id) {
+            ret[i] = static_cast<double>(data.values[j].value) * scale;
+          }
+        }
+      }
+      return ret;
+    }
+};
+
+//! Scenario result.
+struct result {
+  std::size_t ops = 0;
+  double nanos = 0.0;
+  perf_counters::values counters{};
+};
+
+//! Counters of the running scenario.
+perf_counters *active = nullptr;
+//! Time excluded from the running scenario.
+std::chrono::steady_clock::duration paused{};
+std::chrono::steady_clock::time_point pausedAt{};
+
+//! Exclude the following code (eg. setup) from the measurement.
+void pause_measure() {
+  active->pause();
+  pausedAt = std::chrono::steady_clock::now();
+}
+
+//! Include the following code in the measurement.
+void resume_measure() {
+  paused += std::chrono::steady_clock::now() - pausedAt;
+  active->resume();
+}
+
+/**
+ * @brief Run a scenario measuring elapsed time and hardware counters.
+ * @param[in] fn Scenario returning the number of performed operations.
+ */
+template<typename Fn>
+result measure(perf_counters &counters, Fn fn) {
+  result ret;
+  active = &counters;
+  paused = {};
+  counters.start();
+  auto t1 = std::chrono::steady_clock::now();
+  ret.ops = fn();
+  auto t2 = std::chrono::steady_clock::now();
+  ret.counters = counters.stop();
+  ret.nanos = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1 - paused).count());
+  return ret;
+}
+
+std::string format(double value, double ops) {
+  if (value < 0.0) return "n/a";
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.3f", value / ops);
+  return buf;
+}
+
+void report(std::string_view scenario, std::string_view container, const result &res) {
+  using enum perf_counters::counter;
+  const auto &c = res.counters;
+  double ops = static_cast<double>(res.ops);
+  double ipc = (c[INSTRUCTIONS] < 0.0 || c[CYCLES] <= 0.0 ? -1.0 : c[INSTRUCTIONS] / c[CYCLES]);
+  std::printf("%-22s %-8s %10.3f %8s %8s %10s %10s %10s\n",
+      std::string(scenario).c_str(), std::string(container).c_str(),
+      res.nanos / ops,
+      format(c[INSTRUCTIONS], ops).c_str(),
+      format(ipc, 1.0).c_str(),
+      format(c[L1D_MISSES], ops).c_str(),
+      format(c[LLC_MISSES], ops).c_str(),
+      format(c[BRANCH_MISSES], ops).c_str());
+}
+
+// ---------------------------------------------------------------------------
+// scenarios (templated on the container type, return number of operations)
+// ---------------------------------------------------------------------------
+
+volatile long sink = 0;
+
+//! Push n items and pop n items repeatedly (see cqueue-prof.cpp).
+template<typename Container>
+std::size_t push_pop_batch() {
+  constexpr int NUM_ITERATIONS = 1'000'000;
+  constexpr int BATCH_SIZE = 20;
+  Container queue;
+  for (int i = 0; i < 8; i++) queue.push_back(i);
+  for (int i = 0; i < NUM_ITERATIONS; i++) {
+    for (int j = 0; j < BATCH_SIZE; j++) queue.push_back(i);
+    for (int j = 0; j < BATCH_SIZE; j++) queue.pop_front();
+  }
+  return 2 * NUM_ITERATIONS * BATCH_SIZE;
+}
+
+//! Fill up to a large size, then drain.
+template<typename Container>
+std::size_t fill_drain() {
+  constexpr int N = 10'000'000;
+  Container queue;
+  for (int i = 0; i < N; i++) queue.push_back(i);
+  long sum = 0;
+  while (!queue.empty()) {
+    sum += queue.front();
+    queue.pop_front();
+  }
+  sink = sum;
+  return 2 * N;
+}
+
+//! Sequential traversal through iterators.
+template<typename Container>
+std::size_t iterate() {
+  constexpr int N = 1'000'000;
+  constexpr int ROUNDS = 20;
+  Container queue;
+  for (int i = 0; i < N; i++) queue.push_back(i);
+  for (int i = 0; i < N / 2; i++) { queue.pop_front(); queue.push_back(i); }
+  long sum = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int x : queue) sum += x;
+  }
+  sink = sum;
+  return static_cast<std::size_t>(N) * ROUNDS;
+}
+
+//! Random access by position.
+template<typename Container>
+std::size_t random_access() {
+  constexpr std::size_t N = 1'000'000;
+  constexpr std::size_t NUM_PROBES = 10'000'000;
+  Container queue;
+  for (std::size_t i = 0; i < N; i++) queue.push_back(static_cast<int>(i));
+  std::uint64_t seed = 42;
+  long sum = 0;
+  for (std::size_t i = 0; i < NUM_PROBES; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    sum += queue[static_cast<std::size_t>(seed >> 33) % N];
+  }
+  sink = sum;
+  return NUM_PROBES;
+}
+
+//! Sort a wrapped queue (gto::sort, or std::sort over the container iterators).
+template<typename Container, bool Segmented = true>
+std::size_t sort() {
+  constexpr std::size_t N = 5'000'000;
+  pause_measure();
+  Container queue;
+  std::uint64_t seed = 42;
+  for (std::size_t i = 0; i < N; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    queue.push_back(static_cast<int>(seed >> 33));
+  }
+  for (std::size_t i = 0; i < N / 3; i++) {
+    queue.push_back(queue.front());
+    queue.pop_front();
+  }
+  resume_measure();
+  if constexpr (Segmented && !std::is_same_v<Container, std::deque<int>>) {
+    gto::sort(queue);
+  } else {
+    std::sort(queue.begin(), queue.end());
+  }
+  sink = queue[N / 2];
+  return N;
+}
+
+//! Contiguous access to a wrapped queue (linearize in place vs copy into a vector, setup excluded).
+template<bool InPlace>
+std::size_t linearize() {
+  constexpr std::size_t N = 1 << 20;
+  constexpr std::size_t ROUNDS = 50;
+  pause_measure();
+  cqueue<int> queue;
+  for (std::size_t i = 0; i < N; i++) queue.push_back(static_cast<int>(i));
+  resume_measure();
+  std::uint64_t hash = 0;
+  for (std::size_t r = 0; r < ROUNDS; r++) {
+    queue.pop_front();
+    queue.push_back(static_cast<int>(r));
+    if constexpr (InPlace) {
+      for (int x : queue.linearize()) hash = hash * 31 + static_cast<std::uint64_t>(x);
+    } else {
+      std::vector<int> content(queue.begin(), queue.end());
+      for (int x : content) hash = hash * 31 + static_cast<std::uint64_t>(x);
+    }
+  }
+  sink = static_cast<long>(hash);
+  return N * ROUNDS;
+}
+
+//! Clear a large queue (setup excluded).
+template<typename Container>
+std::size_t clear() {
+  constexpr std::size_t N = 10'000'000;
+  constexpr std::size_t ROUNDS = 10;
+  Container queue;
+  for (std::size_t r = 0; r < ROUNDS; r++) {
+    pause_measure();
+    for (std::size_t i = 0; i < N; i++) queue.push_back(static_cast<int>(i));
+    resume_measure();
+    queue.clear();
+  }
+  return N * ROUNDS;
+}
+
+//! Dispatch strings from the front (consume in place vs pop).
+template<bool InPlace>
+std::size_t consume() {
+  constexpr std::size_t N = 1'000'000;
+  constexpr std::size_t ROUNDS = 20;
+  cqueue<std::string> queue;
+  std::size_t len = 0;
+  for (std::size_t r = 0; r < ROUNDS; r++) {
+    pause_measure();
+    for (std::size_t i = 0; i < N; i++) queue.push_back(std::string(8, 'x'));
+    resume_measure();
+    if constexpr (InPlace) {
+      queue.drain([&len](const std::string &msg) { len += msg.size(); });
+    } else {
+      while (!queue.empty()) len += queue.pop_front().size();
+    }
+  }
+  sink = static_cast<long>(len);
+  return N * ROUNDS;
+}
+
+//! Route bursts from an ingress queue to worker queues (transfer vs pop/push).
+template<bool Bulk>
+std::size_t transfer() {
+  constexpr std::size_t NUM_WORKERS = 4;
+  constexpr std::size_t BURST = 64;
+  constexpr std::size_t ROUNDS = 500'000;
+  cqueue<int> ingress;
+  std::array<cqueue<int>, NUM_WORKERS> workers;
+  for (std::size_t r = 0; r < ROUNDS; r++) {
+    pause_measure();
+    for (std::size_t i = 0; i < BURST * NUM_WORKERS; i++) ingress.push_back(static_cast<int>(i));
+    resume_measure();
+    for (auto &worker : workers) {
+      if constexpr (Bulk) {
+        ingress.transfer_front(worker, BURST);
+      } else {
+        for (std::size_t i = 0; i < BURST; i++) worker.push_back(ingress.pop_front());
+      }
+    }
+    pause_measure();
+    for (auto &worker : workers) worker.clear();
+    resume_measure();
+  }
+  return BURST * NUM_WORKERS * ROUNDS;
+}
+
+struct scenario {
+  std::string_view name;
+  std::size_t (*cqueue_fn)();
+  std::size_t (*baseline_fn)();
+  std::string_view baseline = "deque";
+};
+
+const std::vector<scenario> scenarios = {
+  {"push_pop_batch", push_pop_batch<cqueue<int>>, push_pop_batch<std::deque<int>>},
+  {"fill_drain", fill_drain<cqueue<int>>, fill_drain<std::deque<int>>},
+  {"iterate", iterate<cqueue<int>>, iterate<std::deque<int>>},
+  {"random_access", random_access<cqueue<int>>, random_access<std::deque<int>>},
+  {"sort", sort<cqueue<int>>, sort<cqueue<int>, false>, "iterator"},
+  {"sort", nullptr, sort<std::deque<int>>},
+  {"linearize", linearize<true>, linearize<false>, "vector"},
+  {"clear", clear<cqueue<int>>, clear<std::deque<int>>},
+  {"consume", consume<true>, consume<false>, "pop"},
+  {"transfer", transfer<true>, transfer<false>, "pop/push"},
+};
+
+int main(int argc, char *argv[]) {
+  perf_counters counters;
+
+  if (!counters.available()) {
+    std::cerr << "warning: perf_event_open unavailable, reporting elapsed time only" << std::endl;
+  }
+
+  std::printf("%-22s %-8s %10s %8s %8s %10s %10s %10s\n",
+      "scenario", "queue", "ns/op", "ins/op", "IPC", "L1Dmiss/op", "LLCmiss/op", "brmiss/op");
+
+  for (const auto &sc : scenarios) {
+    if (argc > 1 && std::find(argv + 1, argv + argc, sc.name) == argv + argc) {
+      continue;
+    }
+    if (sc.cqueue_fn != nullptr) {
+      report(sc.name, "cqueue", measure(counters, sc.cqueue_fn));
+    }
+    if (sc.baseline_fn != nullptr) {
+      report(sc.name, sc.baseline, measure(counters, sc.baseline_fn));
+    }
+  }
+
+  return 0;
+}
@@ -1,6 +1,10 @@
 #define CATCH_CONFIG_MAIN
 
+#include <deque>
 #include <limits>
+#include <sstream>
+#include <iterator>
+#include <vector>
 #include <ranges>
 #include "catch.hpp"
 #include "cqueue.hpp"
@@ -37,11 +41,22 @@ constexpr bool operator== (const custom_allocator<T>&, const custom_allocator<U>
 template <class T, class U>
 constexpr bool operator!= (const custom_allocator<T>&, const custom_allocator<U>&) noexcept { return true; }
 
+template <class T>
+struct destroy_counting_allocator : std::allocator<T>
+{
+  using propagate_on_container_swap = std::true_type;
+  template <class U> struct rebind { using other = destroy_counting_allocator<U>; };
+  static inline std::size_t numDestroys = 0;
+  void destroy(T *p) { ++numDestroys; p->~T(); }
+};
+
 TEST_CASE("cqueue") {
 
   SECTION("sizeof") {
     CHECK(sizeof(cqueue<int>) == sizeof(int *) + 4*sizeof(std::size_t));
     CHECK(sizeof(cqueue<int, custom_allocator<int>>) == sizeof(int *) + 5*sizeof(std::size_t));
+    CHECK(sizeof(cqueue<int, std::allocator<int>, gto::cqueue_nostats>) == sizeof(int *) + 4*sizeof(std::size_t));
+    CHECK(sizeof(cqueue<int, std::allocator<int>, gto::cqueue_stats>) == sizeof(int *) + 4*sizeof(std::size_t) + sizeof(gto::cqueue_stats));
   }
 
   SECTION("max_capacity") {
@@ -195,6 +210,129 @@ TEST_CASE("cqueue") {
     CHECK(queue1[0] == 99);
   }
 
+  SECTION("copy-wrapped") {
+    using queue_type = cqueue<int, std::allocator<int>, gto::cqueue_stats>;
+    queue_type queue1;
+    // content = [8,9,10,11,4,5,6,7]
+    for (int i = 0; i < 8; i++) {
+      queue1.push(i);
+    }
+    for (int i = 8; i < 12; i++) {
+      queue1.pop();
+      queue1.push(i);
+    }
+    queue_type queue2(queue1);
+    CHECK(queue2.stats().resizes == 1);
+    CHECK(queue2.reserved() == 8);
+    CHECK(std::equal(queue1.begin(), queue1.end(), queue2.begin(), queue2.end()));
+    cqueue<string> queue3;
+    for (int i = 0; i < 30; i++) {
+      queue3.push(std::to_string(i));
+      if (i % 3 == 0) queue3.pop();
+    }
+    cqueue<string> queue4(queue3);
+    CHECK(std::equal(queue3.begin(), queue3.end(), queue4.begin(), queue4.end()));
+  }
+
+  SECTION("copy-assignment-reuse") {
+    cqueue<int> queue1;
+    for (int i = 0; i < 20; i++) {
+      queue1.push(i);
+    }
+    for (int i = 0; i < 15; i++) {
+      queue1.pop();
+    }
+    cqueue<int> queue2;
+    for (int i = 0; i < 10; i++) {
+      queue2.push(-i);
+    }
+    const int *data = &queue2[0];
+    CHECK(queue2.reserved() == 16);
+    // same buffer reused
+    queue2 = queue1;
+    CHECK(queue2.reserved() == 16);
+    CHECK(&queue2[0] == data);
+    CHECK(std::equal(queue1.begin(), queue1.end(), queue2.begin(), queue2.end()));
+    // self-assignment
+    auto &ref = queue2;
+    queue2 = ref;
+    CHECK(queue2.size() == 5);
+    CHECK(queue2[0] == 15);
+    // reserved exceeds capacity, buffer not reused
+    cqueue<int> queue3(10);
+    queue3.push(1);
+    queue2 = queue3;
+    CHECK(queue2.capacity() == 10);
+    CHECK(queue2.reserved() == 8);
+    CHECK(queue2.size() == 1);
+    // not enough room, buffer not reused
+    cqueue<string> queue4;
+    queue4.push("a");
+    cqueue<string> queue5;
+    for (int i = 0; i < 9; i++) {
+      queue5.push(std::to_string(i));
+    }
+    queue4 = queue5;
+    CHECK(queue4.size() == 9);
+    CHECK(queue4.reserved() == 16);
+    CHECK(queue4.back() == "8");
+  }
+
+  SECTION("initializer-list") {
+    cqueue<int> queue1{1, 2, 3};
+    CHECK(queue1.capacity() == 0);
+    CHECK(queue1.size() == 3);
+    CHECK(queue1.reserved() == 8);
+    CHECK(queue1[0] == 1);
+    CHECK(queue1[2] == 3);
+    queue1 = {4, 5};
+    CHECK(queue1.size() == 2);
+    CHECK(queue1[0] == 4);
+    CHECK(queue1[1] == 5);
+    cqueue<string> queue2{"a", "b"};
+    CHECK(queue2.size() == 2);
+    CHECK(queue2.back() == "b");
+    // braces are elements, parentheses are capacity
+    cqueue<int> queue3{10};
+    CHECK(queue3.size() == 1);
+    CHECK(queue3.capacity() == 0);
+    cqueue<int> queue4(10);
+    CHECK(queue4.empty());
+    CHECK(queue4.capacity() == 10);
+  }
+
+  SECTION("range-constructor") {
+    std::vector<int> values{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    cqueue<int> queue1(values.begin(), values.end());
+    CHECK(queue1.size() == 9);
+    CHECK(queue1.reserved() == 16);
+    CHECK(std::equal(values.begin(), values.end(), queue1.begin(), queue1.end()));
+    cqueue<int> queue2(queue1.begin() + 2, queue1.end());
+    CHECK(queue2.size() == 7);
+    CHECK(queue2.front() == 3);
+    std::istringstream stream("1 2 3");
+    cqueue<int> queue3(std::istream_iterator<int>(stream), std::istream_iterator<int>{});
+    CHECK(queue3.size() == 3);
+    CHECK(queue3.back() == 3);
+  }
+
+  SECTION("assign") {
+    cqueue<string> queue(4);
+    queue.push("x");
+    std::vector<string> values{"a", "b", "c"};
+    queue.assign(values.begin(), values.end());
+    CHECK(queue.size() == 3);
+    CHECK(queue.capacity() == 4);
+    CHECK(queue.front() == "a");
+    CHECK(queue.back() == "c");
+    std::vector<string> many(5, "z");
+    CHECK_THROWS_AS(queue.assign(many.begin(), many.end()), std::length_error);
+    CHECK(queue.size() == 3);
+    queue.assign({"d"});
+    CHECK(queue.size() == 1);
+    CHECK(queue.front() == "d");
+  }
+
   SECTION("capacity") {
     {
       cqueue<int> queue;
@@ -953,6 +1091,59 @@ TEST_CASE("cqueue") {
     CHECK(queue.empty());
   }
 
+  SECTION("destroy") {
+    static int alive = 0;
+    struct tracked {
+      std::string str;
+      tracked(int x) : str(std::to_string(x)) { alive++; }
+      tracked(const tracked &o) : str(o.str) { alive++; }
+      tracked(tracked &&o) noexcept : str(std::move(o.str)) { alive++; }
+      tracked& operator=(const tracked &o) = default;
+      tracked& operator=(tracked &&o) noexcept = default;
+      ~tracked() { alive--; }
+    };
+    {
+      cqueue<tracked> queue;
+      // content = [10,11,12,13,4,5,6,7,8,9,.,.,.,.,.,.]
+      for (int i = 0; i < 10; i++) {
+        queue.emplace(i);
+      }
+      for (int i = 0; i < 4; i++) {
+        queue.pop();
+        queue.emplace(10 + i);
+      }
+      CHECK(alive == 10);
+      queue.pop_back();
+      CHECK(alive == 9);
+      queue.erase(queue.begin() + 1, queue.begin() + 3);
+      CHECK(alive == 7);
+      queue.shrink_to_fit();
+      CHECK(alive == 7);
+      CHECK(queue.front().str == "4");
+      CHECK(queue.back().str == "12");
+      queue.clear();
+      CHECK(alive == 0);
+      for (int i = 0; i < 5; i++) {
+        queue.emplace(i);
+      }
+    }
+    CHECK(alive == 0);
+
+    // allocator::destroy() called even for trivially destructible types
+    destroy_counting_allocator<int>::numDestroys = 0;
+    {
+      cqueue<int, destroy_counting_allocator<int>> queue;
+      queue.reserve(16);
+      for (int i = 0; i < 10; i++) {
+        queue.push(i);
+      }
+      queue.pop();
+      CHECK(destroy_counting_allocator<int>::numDestroys == 1);
+      queue.clear();
+      CHECK(destroy_counting_allocator<int>::numDestroys == 10);
+    }
+  }
+
   SECTION("swap") {
     cqueue<int> queue1(2);
     cqueue<int> queue2(10);
@@ -1156,6 +1347,612 @@ TEST_CASE("cqueue") {
     CHECK(queue[4] == 1);
   }
 
+  SECTION("try_push") {
+    cqueue<string> queue(3);
+    CHECK(queue.try_push("b"));
+    CHECK(queue.try_push_front("a"));
+    string str = "c";
+    CHECK(queue.try_push_back(std::move(str)));
+    CHECK(queue.full());
+    CHECK(!queue.try_push("d"));
+    CHECK(!queue.try_push_front("d"));
+    CHECK(queue.try_emplace_back(3, 'x') == nullptr);
+    CHECK(queue.try_emplace_front(3, 'x') == nullptr);
+    CHECK(queue.size() == 3);
+    CHECK(queue[0] == "a");
+    CHECK(queue[1] == "b");
+    CHECK(queue[2] == "c");
+    queue.pop();
+    auto ptr = queue.try_emplace_back(3, 'x');
+    REQUIRE(ptr != nullptr);
+    CHECK(*ptr == "xxx");
+    CHECK(ptr == &queue.back());
+    queue.pop_back();
+    ptr = queue.try_emplace_front(2, 'y');
+    REQUIRE(ptr != nullptr);
+    CHECK(ptr == &queue.front());
+    CHECK(queue.front() == "yy");
+  }
+
+  SECTION("try_pop") {
+    cqueue<std::unique_ptr<int>> queue;
+    std::unique_ptr<int> val;
+    CHECK(!queue.try_pop(val));
+    CHECK(!queue.try_pop_back(val));
+    CHECK(!queue.try_pop().has_value());
+    CHECK(!queue.try_pop_back().has_value());
+    for (int i = 1; i <= 4; i++) {
+      queue.push(std::make_unique<int>(i));
+    }
+    CHECK(queue.try_pop_front(val));
+    REQUIRE(val != nullptr);
+    CHECK(*val == 1);
+    CHECK(queue.try_pop_back(val));
+    CHECK(*val == 4);
+    auto opt = queue.try_pop_front();
+    REQUIRE(opt.has_value());
+    CHECK(**opt == 2);
+    opt = queue.try_pop_back();
+    REQUIRE(opt.has_value());
+    CHECK(**opt == 3);
+    CHECK(queue.empty());
+    CHECK(!queue.try_pop().has_value());
+  }
+
+  SECTION("prepare_back") {
+    cqueue<int> queue;
+    // content = [.,.,2,3,4,5,.,.]
+    for (int i = 0; i < 6; i++) {
+      queue.push(i);
+    }
+    queue.pop();
+    queue.pop();
+    auto [span1, span2] = queue.prepare_back(2);
+    CHECK(queue.reserved() == 8);
+    CHECK(span1.size() == 2);
+    CHECK(span2.empty());
+    CHECK(span1.data() == &queue.back() + 1);
+    std::construct_at(span1.data(), 6);
+    queue.commit_back(1);
+    CHECK(queue.size() == 5);
+    CHECK(queue.back() == 6);
+    // wrapped slots
+    auto segments = queue.prepare_back(3);
+    CHECK(segments.first.size() == 1);
+    CHECK(segments.second.size() == 2);
+    CHECK(segments.second.data() == &queue.front() - 2);
+    segments.first[0] = 7;
+    segments.second[0] = 8;
+    segments.second[1] = 9;
+    queue.commit_back(3);
+    CHECK(queue.size() == 8);
+    CHECK(queue[5] == 7);
+    CHECK(queue[6] == 8);
+    CHECK(queue[7] == 9);
+    CHECK_THROWS(queue.commit_back(1));
+    // reallocation
+    segments = queue.prepare_back(3);
+    CHECK(queue.reserved() == 16);
+    CHECK(segments.first.size() == 3);
+    CHECK(segments.second.empty());
+    queue.commit_back(0);
+    CHECK(queue.size() == 8);
+    CHECK(queue.front() == 2);
+    CHECK(queue.back() == 9);
+    // capacity exceeded
+    cqueue<string> bounded(3);
+    bounded.push("a");
+    CHECK_THROWS_AS(bounded.prepare_back(3), std::length_error);
+    auto slots = bounded.prepare_back(2);
+    std::construct_at(slots.first.data(), "b");
+    bounded.commit_back(1);
+    CHECK(bounded.size() == 2);
+    CHECK(bounded.back() == "b");
+    CHECK(bounded.prepare_back(0).first.empty());
+  }
+
+  SECTION("spans") {
+    cqueue<int> queue;
+    CHECK(queue.spans().first.empty());
+    CHECK(queue.spans().second.empty());
+    for (int i = 0; i < 6; i++) queue.push(i);
+    for (int i = 0; i < 4; i++) queue.pop();
+    for (int i = 6; i < 10; i++) queue.push(i);
+    // content = {4,5,6,7,8,9}, buffer wrapped
+    REQUIRE(queue.reserved() == 8);
+    auto [seg1, seg2] = queue.spans();
+    CHECK(std::vector<int>(seg1.begin(), seg1.end()) == std::vector<int>{4, 5, 6, 7});
+    CHECK(std::vector<int>(seg2.begin(), seg2.end()) == std::vector<int>{8, 9});
+    auto [seg3, seg4] = queue.spans(1, 2);
+    CHECK(std::vector<int>(seg3.begin(), seg3.end()) == std::vector<int>{5, 6});
+    CHECK(seg4.empty());
+    auto [seg5, seg6] = queue.spans(4, 2);
+    CHECK(seg5.data() == &queue[4]);
+    CHECK(seg5.size() == 2);
+    CHECK(seg6.empty());
+    CHECK(queue.spans(6, 0).first.empty());
+    CHECK_THROWS(queue.spans(5, 2));
+    CHECK_THROWS(queue.spans(7, 0));
+  }
+
+  SECTION("prepare_front") {
+    cqueue<string> queue;
+    // content = [.,.,.,.,.,.,.,.]
+    auto [span1, span2] = queue.prepare_front(3);
+    CHECK(queue.reserved() == 8);
+    CHECK(span1.size() == 3);
+    CHECK(span2.empty());
+    std::construct_at(span1.data() + 1, "b");
+    std::construct_at(span1.data() + 2, "c");
+    queue.commit_front(2);
+    CHECK(queue.size() == 2);
+    CHECK(queue.front() == "b");
+    CHECK(queue.back() == "c");
+    queue.clear();
+    queue.push("x");
+    queue.push("b");
+    queue.push("c");
+    queue.push("d");
+    queue.pop();
+    // content = [.,b,c,d,.,.,.,.] -> wrapped slots
+    auto segments = queue.prepare_front(2);
+    CHECK(segments.first.size() == 1);
+    CHECK(segments.second.size() == 1);
+    CHECK(segments.second.data() == &queue.front() - 1);
+    std::construct_at(segments.first.data(), "z");
+    std::construct_at(segments.second.data(), "a");
+    queue.commit_front(2);
+    CHECK(queue.size() == 5);
+    CHECK(queue[0] == "z");
+    CHECK(queue[1] == "a");
+    CHECK(queue[2] == "b");
+    CHECK(queue[4] == "d");
+  }
+
+  SECTION("transfer_front") {
+    cqueue<int> queue1;
+    cqueue<int> queue2;
+    // queue1 = [10,11,12,13,14,5,6,7,8,9,.,.,.,.,.,.]
+    for (int i = 0; i < 10; i++) {
+      queue1.push(i);
+    }
+    for (int i = 10; i < 15; i++) {
+      queue1.pop();
+      queue1.push(i);
+    }
+    // queue2 = [.,.,.,.,.,100,101,.]
+    for (int i = 0; i < 7; i++) {
+      queue2.push(95 + i);
+    }
+    for (int i = 0; i < 5; i++) {
+      queue2.pop();
+    }
+    CHECK(queue1.transfer_front(queue2, 0) == 0);
+    CHECK(queue1.transfer_front(queue2, 6) == 6);
+    CHECK(queue1.size() == 4);
+    CHECK(queue1.front() == 11);
+    CHECK(queue2.size() == 8);
+    CHECK(queue2.reserved() == 8);
+    CHECK(queue2[0] == 100);
+    CHECK(queue2[1] == 101);
+    for (std::size_t i = 2; i < 8; i++) {
+      CHECK(queue2[i] == static_cast<int>(i) + 3);
+    }
+    CHECK(queue1.transfer_front(queue2, 100) == 4);
+    CHECK(queue1.empty());
+    CHECK(queue2.size() == 12);
+    CHECK(queue2.back() == 14);
+    CHECK(queue1.transfer_front(queue1, 1) == 0);
+    // bounded destination
+    cqueue<string> queue3;
+    cqueue<string> queue4(3);
+    for (int i = 0; i < 5; i++) {
+      queue3.push(std::to_string(i));
+    }
+    queue4.push("x");
+    CHECK(queue3.transfer_front(queue4, 5) == 2);
+    CHECK(queue3.size() == 3);
+    CHECK(queue3.front() == "2");
+    CHECK(queue4.size() == 3);
+    CHECK(queue4[1] == "0");
+    CHECK(queue4[2] == "1");
+  }
+
+  SECTION("splice_back") {
+    using queue_type = cqueue<std::unique_ptr<int>, std::allocator<std::unique_ptr<int>>, gto::cqueue_stats>;
+    queue_type queue1;
+    queue_type queue2;
+    for (int i = 0; i < 5; i++) {
+      queue1.push(std::make_unique<int>(i));
+    }
+    // empty destination steals the buffer
+    auto *data = &queue1.front();
+    CHECK(queue2.splice_back(queue1) == 5);
+    CHECK(queue1.empty());
+    CHECK(queue1.reserved() == 0);
+    CHECK(queue2.size() == 5);
+    CHECK(&queue2.front() == data);
+    CHECK(queue2.stats().pushes == 5);
+    CHECK(queue1.stats().pops == 5);
+    // non-empty destination
+    for (int i = 5; i < 8; i++) {
+      queue1.push(std::make_unique<int>(i));
+    }
+    CHECK(queue2.splice_back(queue1) == 3);
+    CHECK(queue1.empty());
+    CHECK(queue2.size() == 8);
+    for (std::size_t i = 0; i < 8; i++) {
+      REQUIRE(queue2[i] != nullptr);
+      CHECK(*queue2[i] == static_cast<int>(i));
+    }
+    // destination capacity lower than source reserved
+    cqueue<int> queue3;
+    cqueue<int> queue4(4);
+    for (int i = 0; i < 4; i++) {
+      queue3.push(i);
+    }
+    CHECK(queue4.splice_back(queue3) == 4);
+    CHECK(queue4.reserved() == 4);
+    CHECK(queue3.reserved() == 8);
+    CHECK(queue4.back() == 3);
+  }
+
+  SECTION("consume_front") {
+    cqueue<string> queue;
+    // content = [8,9,10,11,4,5,6,7]
+    for (int i = 0; i < 8; i++) {
+      queue.push(std::to_string(i));
+    }
+    for (int i = 8; i < 12; i++) {
+      queue.pop();
+      queue.push(std::to_string(i));
+    }
+    std::vector<string> processed;
+    auto fn = [&processed](string &str) { processed.push_back(std::move(str)); };
+    CHECK(queue.consume_front(0, fn) == 0);
+    CHECK(queue.consume_front(3, fn) == 3);
+    CHECK(queue.size() == 5);
+    CHECK(queue.front() == "7");
+    CHECK(queue.consume_front(3, fn) == 3);
+    CHECK(queue.size() == 2);
+    CHECK(queue.front() == "10");
+    CHECK(queue.consume_front(100, fn) == 2);
+    CHECK(queue.empty());
+    CHECK(processed == std::vector<string>{"4", "5", "6", "7", "8", "9", "10", "11"});
+    queue.push("x");
+    CHECK(queue.front() == "x");
+    CHECK(queue.consume_front(1, fn) == 1);
+    CHECK(queue.consume_front(1, fn) == 0);
+  }
+
+  SECTION("drain") {
+    cqueue<int, std::allocator<int>, gto::cqueue_stats> queue;
+    for (int i = 0; i < 12; i++) {
+      queue.push(i);
+    }
+    for (int i = 0; i < 6; i++) {
+      queue.pop();
+      queue.push(12 + i);
+    }
+    int sum = 0;
+    CHECK(queue.drain([&sum](int x) { sum += x; }) == 12);
+    CHECK(sum == 6 + 7 + 8 + 9 + 10 + 11 + 12 + 13 + 14 + 15 + 16 + 17);
+    CHECK(queue.empty());
+    CHECK(queue.stats().pops == 18);
+    CHECK(queue.drain([&sum](int x) { sum += x; }) == 0);
+
+    // exception thrown by fn
+    for (int i = 0; i < 5; i++) {
+      queue.push(i);
+    }
+    CHECK_THROWS(queue.drain([](int x) { if (x == 3) throw std::runtime_error("error"); }));
+    CHECK(queue.size() == 2);
+    CHECK(queue.front() == 3);
+  }
+
+  SECTION("insert") {
+    cqueue<int> queue;
+    // content = [6,7,.,.,.,.,4,5]
+    for (int i = 0; i < 8; i++) {
+      queue.push(i);
+    }
+    for (int i = 0; i < 6; i++) {
+      queue.pop();
+    }
+    queue.push(8);
+    queue.push(9);
+    // front side shifted
+    auto it = queue.insert(queue.begin() + 1, 99);
+    CHECK(*it == 99);
+    CHECK(it - queue.begin() == 1);
+    CHECK(queue.size() == 5);
+    CHECK(queue.reserved() == 8);
+    CHECK(queue[0] == 6);
+    CHECK(queue[1] == 99);
+    CHECK(queue[2] == 7);
+    CHECK(queue[3] == 8);
+    CHECK(queue[4] == 9);
+    // back side shifted
+    it = queue.insert(queue.end() - 1, 2, -1);
+    CHECK(it - queue.begin() == 4);
+    CHECK(queue.size() == 7);
+    CHECK(queue[3] == 8);
+    CHECK(queue[4] == -1);
+    CHECK(queue[5] == -1);
+    CHECK(queue[6] == 9);
+    // insert a queue element, with reallocation
+    queue.insert(queue.begin() + 3, 3, queue[6]);
+    CHECK(queue.size() == 10);
+    CHECK(queue.reserved() == 16);
+    CHECK(queue[2] == 7);
+    CHECK(queue[3] == 9);
+    CHECK(queue[5] == 9);
+    CHECK(queue[6] == 8);
+    // insert range
+    std::vector<int> values{100, 101, 102};
+    it = queue.insert(queue.end(), values.begin(), values.end());
+    CHECK(it - queue.begin() == 10);
+    CHECK(queue.size() == 13);
+    CHECK(queue.back() == 102);
+    it = queue.insert(queue.begin(), values.begin(), values.begin());
+    CHECK(it == queue.begin());
+    CHECK(queue.size() == 13);
+    // invalid position
+    CHECK_THROWS(queue.insert(queue.end() + 1, 0));
+    CHECK_THROWS(queue.insert(queue.begin() - 1, 0));
+    // capacity exceeded
+    cqueue<string> bounded(3);
+    bounded.push("a");
+    bounded.push("c");
+    bounded.insert(bounded.begin() + 1, "b");
+    CHECK(bounded[1] == "b");
+    CHECK_THROWS_AS(bounded.insert(bounded.begin(), "x"), std::length_error);
+    CHECK(bounded.size() == 3);
+  }
+
+  SECTION("erase") {
+    cqueue<string> queue;
+    // content = [6,7,.,.,.,.,4,5]
+    for (int i = 0; i < 8; i++) {
+      queue.push(std::to_string(i));
+    }
+    for (int i = 0; i < 4; i++) {
+      queue.pop();
+    }
+    queue.push("8");
+    queue.push("9");
+    CHECK(queue.size() == 6);
+    // content = [4,5,6,7,8,9] -> [4,6,7,8,9]
+    auto it = queue.erase(queue.begin() + 1);
+    CHECK(*it == "6");
+    CHECK(queue.size() == 5);
+    CHECK(queue.front() == "4");
+    CHECK(queue[1] == "6");
+    // content = [4,6,7,8,9] -> [4,6,9]
+    it = queue.erase(queue.begin() + 2, queue.begin() + 4);
+    CHECK(*it == "9");
+    CHECK(queue.size() == 3);
+    CHECK(queue[0] == "4");
+    CHECK(queue[1] == "6");
+    CHECK(queue[2] == "9");
+    // content = [4,6,9] -> [4,6]
+    it = queue.erase(queue.end() - 1);
+    CHECK(it == queue.end());
+    it = queue.erase(queue.begin(), queue.begin());
+    CHECK(it == queue.begin());
+    CHECK(queue.size() == 2);
+    CHECK_THROWS(queue.erase(queue.end()));
+    it = queue.erase(queue.begin(), queue.end());
+    CHECK(queue.empty());
+    CHECK(it == queue.end());
+    queue.push("x");
+    CHECK(queue.front() == "x");
+  }
+
+  SECTION("insert-erase-random") {
+    std::uint64_t seed = 1;
+    auto rand = [&seed](std::size_t n) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      return static_cast<std::ptrdiff_t>((seed >> 33) % (n + 1));
+    };
+    cqueue<int> queue1;
+    cqueue<string> queue2(100);
+    std::deque<int> expected;
+    for (int i = 0; i < 2000; i++) {
+      auto pos = rand(expected.size());
+      switch (rand(5)) {
+        case 0:
+        case 1: {
+          auto n = static_cast<std::size_t>(rand(3));
+          if (expected.size() + n > 100) break;
+          queue1.insert(queue1.begin() + pos, n, i);
+          queue2.insert(queue2.begin() + pos, n, std::to_string(i));
+          expected.insert(expected.begin() + pos, n, i);
+          break;
+        }
+        case 2: {
+          if (expected.size() + 1 > 100) break;
+          queue1.insert(queue1.begin() + pos, i);
+          queue2.insert(queue2.begin() + pos, std::to_string(i));
+          expected.insert(expected.begin() + pos, i);
+          break;
+        }
+        default: {
+          auto n = std::min(rand(4), static_cast<std::ptrdiff_t>(expected.size()) - pos);
+          queue1.erase(queue1.begin() + pos, queue1.begin() + pos + n);
+          queue2.erase(queue2.begin() + pos, queue2.begin() + pos + n);
+          expected.erase(expected.begin() + pos, expected.begin() + pos + n);
+          break;
+        }
+      }
+      REQUIRE(queue1.size() == expected.size());
+      REQUIRE(queue2.size() == expected.size());
+      REQUIRE(std::equal(queue1.begin(), queue1.end(), expected.begin()));
+      REQUIRE(std::equal(queue2.begin(), queue2.end(), expected.begin(), [](const string &a, int b) { return a == std::to_string(b); }));
+    }
+  }
+
+  SECTION("linearize") {
+    // empty queue
+    {
+      cqueue<int> queue;
+      CHECK(queue.linearize().empty());
+      queue.push(1);
+      queue.pop();
+      CHECK(queue.linearize().empty());
+      CHECK(queue.reserved() == 8);
+    }
+    // content = [.,.,.,4,5,6,.,.]
+    {
+      cqueue<int> queue;
+      for (int i = 1; i <= 6; i++) {
+        queue.push(i);
+      }
+      for (int i = 1; i <= 3; i++) {
+        queue.pop();
+      }
+      auto content = queue.linearize();
+      CHECK(content.data() == &queue[0]);
+      CHECK(content.size() == 3);
+      CHECK(content[0] == 4);
+      CHECK(content[2] == 6);
+      CHECK(queue.reserved() == 8);
+      CHECK(queue[0] == 4);
+      CHECK(queue[2] == 6);
+      CHECK(&queue[2] == &queue[0] + 2);
+    }
+    // content = [9,10,.,.,.,6,7,8] and [9,10,3,4,5,6,7,8] (strings)
+    for (int num_pops : {5, 2}) {
+      cqueue<string> queue;
+      for (int i = 1; i <= 8; i++) {
+        queue.push(std::to_string(i));
+      }
+      for (int i = 0; i < num_pops; i++) {
+        queue.pop();
+      }
+      queue.push("9");
+      queue.push("10");
+      auto content = queue.linearize();
+      CHECK(queue.reserved() == 8);
+      CHECK(content.size() == static_cast<std::size_t>(10 - num_pops));
+      for (std::size_t i = 0; i < content.size(); i++) {
+        CHECK(content[i] == std::to_string(static_cast<std::size_t>(num_pops) + i + 1));
+        CHECK(&queue[i] == content.data() + i);
+      }
+      queue.push("11");
+      CHECK(queue.back() == "11");
+    }
+    // only-movable elements, no leaks
+    {
+      static int alive = 0;
+      struct tracked {
+        std::unique_ptr<int> ptr;
+        tracked(int x) : ptr(std::make_unique<int>(x)) { alive++; }
+        tracked(tracked &&o) noexcept : ptr(std::move(o.ptr)) { alive++; }
+        tracked& operator=(tracked &&o) noexcept = default;
+        ~tracked() { alive--; }
+      };
+      {
+        cqueue<tracked> queue;
+        for (int i = 0; i < 16; i++) {
+          queue.emplace(i);
+        }
+        for (int i = 0; i < 11; i++) {
+          queue.pop();
+        }
+        for (int i = 16; i < 20; i++) {
+          queue.emplace(i);
+        }
+        // content = [16,17,18,19,.,.,.,.,.,.,.,11,12,13,14,15]
+        CHECK(alive == 9);
+        auto content = queue.linearize();
+        CHECK(alive == 9);
+        for (std::size_t i = 0; i < content.size(); i++) {
+          CHECK(*content[i].ptr == static_cast<int>(i) + 11);
+        }
+      }
+      CHECK(alive == 0);
+    }
+  }
+
+  SECTION("gto::sort") {
+    cqueue<int> queue;
+    // content = [5,1,.,.,.,9,3,7]
+    for (int x : {0, 0, 0, 0, 0, 9, 3, 7}) {
+      queue.push(x);
+    }
+    for (int i = 0; i < 5; i++) {
+      queue.pop();
+    }
+    queue.push(5);
+    queue.push(1);
+    CHECK(queue.reserved() == 8);
+    gto::sort(queue);
+    CHECK(queue.size() == 5);
+    CHECK(queue.reserved() == 8);
+    CHECK(queue[0] == 1);
+    CHECK(queue[1] == 3);
+    CHECK(queue[2] == 5);
+    CHECK(queue[3] == 7);
+    CHECK(queue[4] == 9);
+    gto::sort(queue, std::greater<int>());
+    CHECK(queue[0] == 9);
+    CHECK(queue[4] == 1);
+    // empty queue
+    cqueue<int> empty;
+    gto::sort(empty);
+    CHECK(empty.empty());
+    // full and wrapped, content = [9,10,3,4,5,6,7,8] (strings)
+    cqueue<string> full;
+    for (int i = 1; i <= 8; i++) {
+      full.push(std::to_string(i));
+    }
+    full.pop();
+    full.pop();
+    full.push("9");
+    full.push("10");
+    CHECK(full.reserved() == 8);
+    gto::sort(full, [](const string &a, const string &b) { return std::stoi(a) < std::stoi(b); });
+    for (std::size_t i = 0; i < full.size(); i++) {
+      CHECK(full[i] == std::to_string(i + 3));
+    }
+  }
+
+  SECTION("gto::stable_sort") {
+    cqueue<std::pair<int,int>> queue(6);
+    // content = [(0,10),(1,11),(2,12),(0,3),(1,4),(2,5)]
+    for (int i = 0; i < 6; i++) {
+      queue.push({i % 3, i});
+    }
+    for (int i = 0; i < 3; i++) {
+      auto item = queue.pop();
+      queue.push({item.first, item.second + 10});
+    }
+    gto::stable_sort(queue, [](const auto &a, const auto &b) { return a.first < b.first; });
+    CHECK(queue[0] == std::pair<int,int>{0, 3});
+    CHECK(queue[1] == std::pair<int,int>{0, 10});
+    CHECK(queue[2] == std::pair<int,int>{1, 4});
+    CHECK(queue[3] == std::pair<int,int>{1, 11});
+    CHECK(queue[4] == std::pair<int,int>{2, 5});
+    CHECK(queue[5] == std::pair<int,int>{2, 12});
+  }
+
+  SECTION("gto::nth_element") {
+    cqueue<string> queue;
+    for (int i = 0; i < 20; i++) {
+      queue.push(std::to_string(100 + (i * 7) % 20));
+    }
+    for (int i = 0; i < 10; i++) {
+      queue.push(queue.pop());
+    }
+    gto::nth_element(queue, 5);
+    CHECK(queue.size() == 20);
+    CHECK(queue[5] == "105");
+    CHECK(std::all_of(queue.begin(), queue.begin() + 5, [](const string &s) { return s < "105"; }));
+    CHECK(std::all_of(queue.begin() + 6, queue.end(), [](const string &s) { return s > "105"; }));
+    CHECK_THROWS(gto::nth_element(queue, 20));
+  }
+
   SECTION("ranges") {
     gto::cqueue<int> numbers;
     for (int i = 1; i <= 6; i++) {
@@ -1213,6 +2010,47 @@ TEST_CASE("cqueue") {
     CHECK(sum == 40);
   }
 
+  SECTION("stats") {
+    cqueue<int, std::allocator<int>, gto::cqueue_stats> queue;
+    CHECK(queue.stats().pushes == 0);
+    CHECK(queue.stats().peak_reserved == 0);
+    for (int i = 0; i < 9; i++) {
+      queue.push(i);
+    }
+    // content = [0,1,2,3,4,5,6,7,8,.,.,.,.,.,.,.]
+    CHECK(queue.stats().pushes == 9);
+    CHECK(queue.stats().pops == 0);
+    CHECK(queue.stats().resizes == 2);
+    CHECK(queue.stats().bytes_relocated == 8 * sizeof(int));
+    CHECK(queue.stats().peak_size == 9);
+    CHECK(queue.stats().peak_reserved == 16);
+    queue.pop();
+    queue.pop_back();
+    queue.push_front(1);
+    queue.emplace_front(0);
+    queue.emplace_back(8);
+    CHECK(queue.stats().pushes == 12);
+    CHECK(queue.stats().pops == 2);
+    CHECK(queue.stats().peak_size == 10);
+    CHECK(queue.stats().shrinks == 0);
+    queue.shrink_to_fit();
+    CHECK(queue.stats().resizes == 3);
+    CHECK(queue.stats().shrinks == 1);
+    CHECK(queue.stats().bytes_relocated == 18 * sizeof(int));
+    queue.clear();
+    CHECK(queue.stats().pops == 2);
+    queue.shrink_to_fit();
+    CHECK(queue.reserved() == 0);
+    CHECK(queue.stats().shrinks == 2);
+    CHECK(queue.stats().peak_reserved == 16);
+
+    // swap exchanges statistics
+    cqueue<int, std::allocator<int>, gto::cqueue_stats> other;
+    other.swap(queue);
+    CHECK(queue.stats().pushes == 0);
+    CHECK(other.stats().pushes == 12);
+  }
+
   SECTION("only-movable-elements") {
     const std::size_t N = 33;
     gto::cqueue<std::unique_ptr<int>> queue;
@@ -1,18 +1,101 @@
 #pragma once
 
+#include <span>
 #include <memory>
 #include <limits>
+#include <cstdlib>
+#include <optional>
 #include <compare>
 #include <cstddef>
+#include <cstring>
 #include <utility>
+#include <initializer_list>
 #include <iterator>
 #include <concepts>
+#include <functional>
 #include <algorithm>
 #include <stdexcept>
 #include <type_traits>
+#ifdef __cpp_lib_containers_ranges
+#include <ranges>
+#endif
+
+// Exceptions can be disabled (-fno-exceptions). In this case errors abort
+// the program; use the try_* methods to handle them without exceptions.
+// These macros are public (see README), the other headers use them too.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+  #define CQUEUE_THROW(ex) throw ex
+  #define CQUEUE_TRY try
+  #define CQUEUE_CATCH_ALL catch (...)
+  #define CQUEUE_RETHROW throw
+#else
+  #define CQUEUE_THROW(ex) std::abort()
+  #define CQUEUE_TRY if (true)
+  #define CQUEUE_CATCH_ALL if (false)
+  #define CQUEUE_RETHROW
+#endif
 
 namespace gto {
 
+/**
+ * @brief Statistics policy that collects nothing (default).
+ * @details All hooks are empty, so they are optimized out.
+ */
+struct cqueue_nostats
+{
+  //! Called after n elements were inserted (length = new size).
+  constexpr void on_push(std::size_t, std::size_t = 1) noexcept {}
+  //! Called after n elements were removed (clear excluded).
+  constexpr void on_pop(std::size_t = 1) noexcept {}
+  //! Called after the buffer was reallocated.
+  constexpr void on_resize(std::size_t, std::size_t, std::size_t) noexcept {}
+  //! Called after the buffer was deallocated by shrink_to_fit().
+  constexpr void on_release(std::size_t) noexcept {}
+};
+
+/**
+ * @brief Statistics policy that counts operations and memory usage.
+ * @details Use it to right-size reserve() calls from real data.
+ */
+struct cqueue_stats
+{
+  //! Number of inserted elements.
+  std::size_t pushes = 0;
+  //! Number of removed elements (clear excluded).
+  std::size_t pops = 0;
+  //! Number of buffer reallocations.
+  std::size_t resizes = 0;
+  //! Number of reallocations/deallocations reducing the reserved memory.
+  std::size_t shrinks = 0;
+  //! Bytes moved from an old buffer to a new one.
+  std::size_t bytes_relocated = 0;
+  //! Maximum number of elements (high-water mark).
+  std::size_t peak_size = 0;
+  //! Maximum buffer size (number of items).
+  std::size_t peak_reserved = 0;
+
+  //! Called after n elements were inserted (length = new size).
+  constexpr void on_push(std::size_t length, std::size_t n = 1) noexcept {
+    pushes += n;
+    peak_size = std::max(peak_size, length);
+  }
+  //! Called after n elements were removed (clear excluded).
+  constexpr void on_pop(std::size_t n = 1) noexcept {
+    pops += n;
+  }
+  //! Called after the buffer was reallocated.
+  constexpr void on_resize(std::size_t from, std::size_t to, std::size_t bytes) noexcept {
+    ++resizes;
+    shrinks += (to < from ? 1 : 0);
+    bytes_relocated += bytes;
+    peak_reserved = std::max(peak_reserved, to);
+  }
+  //! Called after the buffer was deallocated by shrink_to_fit().
+  constexpr void on_release(std::size_t) noexcept {
+    ++shrinks;
+  }
+};
+
 /**
  * @brief Circular queue.
  * 
@@ -20,7 +103,9 @@ namespace gto {
  *          push(), push_back(), push_front(), 
  *          pop(), pop_back(), pop_front(),
  *          emplace(), emplace_back(), emplace_front(),
- *          reserve(), shrink_to_fit(), reset() and clear().
+ *          insert(), erase(), consume_front(), drain(),
+ *          prepare_back(), prepare_front(), transfer_front(),
+ *          splice_back(), reserve(), shrink_to_fit(), reset(), clear() and linearize().
  * 
  * @note This class is not thread-safe.
  * @version 1.0.8
@@ -30,8 +115,9 @@ namespace gto {
  * 
  * @tparam T Elements type (std::movable or std::copyable).
  * @tparam Allocator Allocator type.
+ * @tparam Stats Statistics policy (cqueue_nostats or cqueue_stats).
  */
-template<std::movable T, typename Allocator = std::allocator<T>>
+template<std::movable T, typename Allocator = std::allocator<T>, typename Stats = cqueue_nostats>
 class cqueue
 {
   private: // declarations
@@ -102,10 +188,13 @@ class cqueue
     using allocator_type = Allocator;
     using const_alloc_reference = const allocator_type &;
     using allocator_traits = std::allocator_traits<allocator_type>;
+    using stats_type = Stats;
     using iterator = iter<value_type>;
     using const_iterator = iter<const value_type>;
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using segments = std::pair<std::span<value_type>, std::span<value_type>>;
+    using const_segments = std::pair<std::span<const value_type>, std::span<const value_type>>;
 
   private: // static members
 
@@ -115,12 +204,18 @@ class cqueue
     static constexpr size_type MIN_ALLOCATE = 8;
     //! Maximum capacity.
     static constexpr size_type MAX_CAPACITY = std::numeric_limits<difference_type>::max();
+    //! Destruction can be skipped (trivial destructor and no allocator::destroy()).
+    static constexpr bool TRIVIAL_DESTROY = std::is_trivially_destructible<T>::value &&
+        !requires(allocator_type &alloc, pointer ptr) { alloc.destroy(ptr); };
 
   private: // members
 
     //! Memory allocator.
     [[no_unique_address]]
     allocator_type mAllocator = {};
+    //! Statistics.
+    [[no_unique_address]]
+    stats_type mStats = {};
     //! Buffer.
     pointer mData = nullptr;
     //! Buffer size.
@@ -146,6 +241,20 @@ class cqueue
     void resize(size_type len);
     //! Clear and dealloc memory (preserve capacity and allocator).
     void reset() noexcept;
+    //! Destroy n items starting at position pos.
+    constexpr void destroyItems(size_type pos, size_type n) noexcept;
+    //! Convert from iterator to position (throw exception if out-of-bounds).
+    constexpr size_type getPosition(const_iterator it) const;
+    //! Move-assign n items from position src to position dst.
+    constexpr void moveItems(size_type src, size_type dst, size_type n);
+    //! Append n items (contiguous destination, enough room required).
+    template<typename InputIt>
+    constexpr void appendItems(InputIt first, size_type n);
+    //! Append the content of another queue (contiguous destination, enough room required).
+    constexpr void appendItems(const cqueue &other);
+    //! Insert n items at position pos (fill constructs them in order).
+    template<typename Fill>
+    constexpr void insertItems(size_type pos, size_type n, Fill fill);
 
   public: // static methods
 
@@ -156,9 +265,23 @@ class cqueue
 
     //! Constructor (capacity=0 means unlimited).
     constexpr explicit cqueue(size_type capacity = 0, const_alloc_reference alloc = Allocator());
+    //! Range constructor (unlimited capacity).
+    template<std::input_iterator InputIt>
+    constexpr cqueue(InputIt first, InputIt last, const_alloc_reference alloc = Allocator());
+    //! Initializer list constructor (unlimited capacity, cqueue<int>{10} holds one item, use parentheses for capacity).
+    constexpr cqueue(std::initializer_list<T> ilist, const_alloc_reference alloc = Allocator()) :
+        cqueue(ilist.begin(), ilist.end(), alloc) {}
+#ifdef __cpp_lib_containers_ranges
+    //! Range constructor (unlimited capacity).
+    template<std::ranges::input_range R>
+    constexpr cqueue(std::from_range_t, R &&rg, const_alloc_reference alloc = Allocator()) : cqueue(0, alloc) {
+      auto view = std::views::common(rg);
+      assign(view.begin(), view.end());
+    }
+#endif
     //! Copy constructor.
     constexpr cqueue(const cqueue &other) : 
-        cqueue{other, allocator_traits::select_on_container_copy_construction(other.get_allocator())} {}
+        cqueue(other, allocator_traits::select_on_container_copy_construction(other.get_allocator())) {}
     //! Copy constructor with allocator.
     constexpr cqueue(const cqueue &other, const_alloc_reference alloc);
     //! Move constructor.
@@ -172,6 +295,14 @@ class cqueue
     constexpr cqueue & operator=(const cqueue &other);
     //! Move assignment.
     constexpr cqueue & operator=(cqueue &&other) noexcept { this->swap(other); return *this; }
+    //! Initializer list assignment.
+    constexpr cqueue & operator=(std::initializer_list<T> ilist) { assign(ilist); return *this; }
+
+    //! Replace content with elements from range [first, last).
+    template<std::input_iterator InputIt>
+    constexpr void assign(InputIt first, InputIt last);
+    //! Replace content with elements from initializer list.
+    constexpr void assign(std::initializer_list<T> ilist) { assign(ilist.begin(), ilist.end()); }
 
     //! Return container allocator.
     constexpr allocator_type get_allocator() const noexcept { return mAllocator; }
@@ -185,6 +316,8 @@ class cqueue
     [[nodiscard]] constexpr bool empty() const noexcept { return (mLength == 0); }
     //! Check if the queue is full.
     [[nodiscard]] constexpr bool full() const noexcept { return (size() == mCapacity); }
+    //! Return collected statistics.
+    constexpr const stats_type & stats() const noexcept { return mStats; }
 
     //! Return the first element.
     constexpr const_reference front() const { return operator[](0); }
@@ -225,6 +358,82 @@ class cqueue
     //! Alias to pop_front.
     constexpr value_type pop() { return pop_front(); }
 
+    //! Construct and insert an element at the end (nullptr if full).
+    template <class... Args>
+    constexpr pointer try_emplace_back(Args&&... args);
+    //! Construct and insert an element at the front (nullptr if full).
+    template <class... Args>
+    constexpr pointer try_emplace_front(Args&&... args);
+    //! Insert an element at the end (false if full).
+    constexpr bool try_push_back(const T &val) { return (try_emplace_back(val) != nullptr); }
+    //! Insert an element at the end (false if full).
+    constexpr bool try_push_back(T &&val) { return (try_emplace_back(std::move(val)) != nullptr); }
+    //! Insert an element at the front (false if full).
+    constexpr bool try_push_front(const T &val) { return (try_emplace_front(val) != nullptr); }
+    //! Insert an element at the front (false if full).
+    constexpr bool try_push_front(T &&val) { return (try_emplace_front(std::move(val)) != nullptr); }
+    //! Alias to try_push_back.
+    constexpr bool try_push(const T &val) { return try_push_back(val); }
+    //! Alias to try_push_back.
+    constexpr bool try_push(T &&val) { return try_push_back(std::move(val)); }
+
+    //! Remove the front element moving it to val (false if empty).
+    constexpr bool try_pop_front(T &val);
+    //! Remove the back element moving it to val (false if empty).
+    constexpr bool try_pop_back(T &val);
+    //! Remove the front element (nullopt if empty).
+    constexpr std::optional<value_type> try_pop_front();
+    //! Remove the back element (nullopt if empty).
+    constexpr std::optional<value_type> try_pop_back();
+    //! Alias to try_pop_front.
+    constexpr bool try_pop(T &val) { return try_pop_front(val); }
+    //! Alias to try_pop_front.
+    constexpr std::optional<value_type> try_pop() { return try_pop_front(); }
+
+    //! Reserve n uninitialized slots after the back element.
+    constexpr segments prepare_back(size_type n);
+    //! Publish the first n slots returned by prepare_back().
+    constexpr void commit_back(size_type n);
+    //! Reserve n uninitialized slots before the front element.
+    constexpr segments prepare_front(size_type n);
+    //! Publish the last n slots returned by prepare_front().
+    constexpr void commit_front(size_type n);
+    //! Return the contiguous segments holding n elements starting at pos.
+    constexpr segments spans(size_type pos, size_type n);
+    //! Return the contiguous segments holding all elements.
+    constexpr segments spans() { return spans(0, mLength); }
+    //! Return the contiguous segments holding n elements starting at pos.
+    constexpr const_segments spans(size_type pos, size_type n) const { return const_cast<cqueue *>(this)->spans(pos, n); }
+    //! Return the contiguous segments holding all elements.
+    constexpr const_segments spans() const { return spans(0, mLength); }
+
+    //! Move up to n front elements to the back of dest.
+    constexpr size_type transfer_front(cqueue &dest, size_type n);
+    //! Move all elements of src to the back of this queue.
+    constexpr size_type splice_back(cqueue &src) { return src.transfer_front(*this, src.size()); }
+
+    //! Process up to n front elements in place and remove them.
+    template<typename Fn>
+    constexpr size_type consume_front(size_type n, Fn fn);
+    //! Process all elements in place and remove them.
+    template<typename Fn>
+    constexpr size_type drain(Fn fn) { return consume_front(mLength, fn); }
+
+    //! Insert an element before pos.
+    constexpr iterator insert(const_iterator pos, const T &val) { return insert(pos, 1, val); }
+    //! Insert an element before pos.
+    constexpr iterator insert(const_iterator pos, T &&val);
+    //! Insert n copies of an element before pos.
+    constexpr iterator insert(const_iterator pos, size_type n, const T &val);
+    //! Insert elements from range [first, last) before pos.
+    template<std::input_iterator InputIt>
+    constexpr iterator insert(const_iterator pos, InputIt first, InputIt last);
+
+    //! Remove the element at pos.
+    constexpr iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+    //! Remove the elements in the range [first, last).
+    constexpr iterator erase(const_iterator first, const_iterator last);
+
     //! Returns a reference to the element at position n.
     constexpr reference operator[](size_type n) { return mData[getCheckedIndex(n)]; }
     //! Returns a const reference to the element at position n.
@@ -264,6 +473,8 @@ class cqueue
     constexpr void reserve(size_type n);
     //! Shrink reserved memory to current size.
     constexpr void shrink_to_fit();
+    //! Move content to the buffer start (no reallocation) and return it.
+    constexpr std::span<value_type> linearize();
 };
 
 } // namespace gto
@@ -272,12 +483,12 @@ class cqueue
  * @param[in] capacity Container capacity.
  * @param[in] alloc Allocator to use.
  */
-template<std::movable T, typename Allocator>
-constexpr gto::cqueue<T, Allocator>::cqueue(size_type capacity, const_alloc_reference alloc) :
+template<std::movable T, typename Allocator, typename Stats>
+constexpr gto::cqueue<T, Allocator, Stats>::cqueue(size_type capacity, const_alloc_reference alloc) :
     mAllocator(alloc)
 {
   if (capacity > MAX_CAPACITY) {
-    throw std::length_error("cqueue max capacity exceeded");
+    CQUEUE_THROW(std::length_error("cqueue max capacity exceeded"));
   }
   mCapacity = (capacity == 0 ? MAX_CAPACITY : capacity);
 }
@@ -286,15 +497,35 @@ constexpr gto::cqueue<T, Allocator>::cqueue(size_type capacity, const_alloc_refe
  * @param[in] other Queue to copy.
  * @param[in] alloc Allocator to use.
  */
-template<std::movable T, typename Allocator>
-constexpr gto::cqueue<T, Allocator>::cqueue(const cqueue &other, const_alloc_reference alloc) : 
+template<std::movable T, typename Allocator, typename Stats>
+constexpr gto::cqueue<T, Allocator, Stats>::cqueue(const cqueue &other, const_alloc_reference alloc) : 
     mAllocator{alloc},
     mCapacity{other.mCapacity}
 {
-  // use propagate_on_container_copy_assignment !!!
   resizeIfRequired(other.mLength);
-  for (size_type i = 0; i < other.size(); ++i) {
-    push_back(other[i]);
+  CQUEUE_TRY {
+    appendItems(other);
+  } CQUEUE_CATCH_ALL {
+    reset();
+    CQUEUE_RETHROW;
+  }
+}
+
+/**
+ * @param[in] first Iterator to the first element to copy.
+ * @param[in] last Iterator to the element following the last element to copy.
+ * @param[in] alloc Allocator to use.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template<std::input_iterator InputIt>
+constexpr gto::cqueue<T, Allocator, Stats>::cqueue(InputIt first, InputIt last, const_alloc_reference alloc) :
+    mAllocator(alloc)
+{
+  CQUEUE_TRY {
+    assign(first, last);
+  } CQUEUE_CATCH_ALL {
+    reset();
+    CQUEUE_RETHROW;
   }
 }
 
@@ -302,13 +533,13 @@ constexpr gto::cqueue<T, Allocator>::cqueue(const cqueue &other, const_alloc_ref
  * @param[in] other Queue to copy.
  * @param[in] alloc Allocator to use
  */
-template<std::movable T, typename Allocator>
-constexpr gto::cqueue<T, Allocator>::cqueue(cqueue &&other, const_alloc_reference alloc) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr gto::cqueue<T, Allocator, Stats>::cqueue(cqueue &&other, const_alloc_reference alloc) {
   // use propagate_on_container_move_assignment !!!
   if (alloc == other.mAllocator) {
     swap(other);
   } else {
-    cqueue aux{other, alloc};
+    cqueue aux(other, alloc);
     swap(aux);
   }
 }
@@ -316,19 +547,99 @@ constexpr gto::cqueue<T, Allocator>::cqueue(cqueue &&other, const_alloc_referenc
 /**
  * @param[in] other Queue to copy.
  */
-template<std::movable T, typename Allocator>
-constexpr auto gto::cqueue<T, Allocator>::operator=(const cqueue &other) -> cqueue& {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::operator=(const cqueue &other) -> cqueue& {
+  if (this == &other) {
+    return *this;
+  }
+
+  // reuse current buffer (copy can't fail, strong exception guarantee preserved)
+  if constexpr (std::is_nothrow_copy_constructible<T>::value) {
+    bool sameAllocator = (allocator_traits::is_always_equal::value || mAllocator == other.mAllocator);
+    if (sameAllocator && other.mLength <= mReserved && mReserved <= other.mCapacity) {
+      clear();
+      mCapacity = other.mCapacity;
+      appendItems(other);
+      return *this;
+    }
+  }
+
   cqueue tmp(other);
   this->swap(tmp);
   return *this;
 }
 
+/**
+ * @details Performs a single allocation when the number of elements is known.
+ * @param[in] first Iterator to the first element to copy.
+ * @param[in] last Iterator to the element following the last element to copy.
+ * @exception std::length_error Number of values exceed queue capacity.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template<std::input_iterator InputIt>
+constexpr void gto::cqueue<T, Allocator, Stats>::assign(InputIt first, InputIt last) {
+  if constexpr (std::forward_iterator<InputIt>) {
+    auto n = static_cast<size_type>(std::distance(first, last));
+    if (n > mCapacity) {
+      CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
+    }
+    clear();
+    resizeIfRequired(n);
+    appendItems(first, n);
+  } else {
+    clear();
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+}
+
+/**
+ * @details Items are copied with memcpy when possible.
+ * @param[in] first Iterator to the first element to copy.
+ * @param[in] n Number of elements to copy.
+ * @exception ... Error throwed by copy constructors.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template<typename InputIt>
+constexpr void gto::cqueue<T, Allocator, Stats>::appendItems(InputIt first, size_type n) {
+  pointer dst = mData + mFront + mLength;
+
+  if constexpr (std::is_trivially_copyable<T>::value && std::contiguous_iterator<InputIt> &&
+                std::same_as<std::iter_value_t<InputIt>, T>) {
+    if (n > 0) {
+      std::memcpy(static_cast<void *>(dst), std::to_address(first), n * sizeof(T));
+      mLength += n;
+      mStats.on_push(mLength, n);
+    }
+  } else {
+    for (size_type i = 0; i < n; ++i, ++first) {
+      allocator_traits::construct(mAllocator, dst + i, *first);
+      ++mLength;
+      mStats.on_push(mLength);
+    }
+  }
+}
+
+/**
+ * @details Copies the (at most two) contiguous segments of other.
+ * @param[in] other Queue to copy.
+ * @exception ... Error throwed by copy constructors.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::appendItems(const cqueue &other) {
+  size_type len1 = std::min(other.mLength, other.mReserved - other.mFront);
+  size_type len2 = other.mLength - len1;
+  appendItems(static_cast<const T *>(other.mData + other.mFront), len1);
+  appendItems(static_cast<const T *>(other.mData), len2);
+}
+
 /**
  * @param[in] num Element position.
  * @return Index in buffer.
  */
-template<std::movable T, typename Allocator>
-constexpr auto gto::cqueue<T, Allocator>::getUncheckedIndex(size_type pos) const noexcept {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::getUncheckedIndex(size_type pos) const noexcept {
   // case power of two (performance improvement x5)
   if (mReserved > 1 && (mReserved & (mReserved - 1)) == 0) {
     [[likely]]
@@ -342,10 +653,10 @@ constexpr auto gto::cqueue<T, Allocator>::getUncheckedIndex(size_type pos) const
  * @return Index in buffer.
  * @exception std::out_of_range Invalid position.
  */
-template<std::movable T, typename Allocator>
-constexpr auto gto::cqueue<T, Allocator>::getCheckedIndex(size_type pos) const noexcept(false) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::getCheckedIndex(size_type pos) const noexcept(false) {
   if (pos >= mLength) {
-    throw std::out_of_range("cqueue access out-of-range");
+    CQUEUE_THROW(std::out_of_range("cqueue access out-of-range"));
   }
   return getUncheckedIndex(pos);
 }
@@ -353,21 +664,41 @@ constexpr auto gto::cqueue<T, Allocator>::getCheckedIndex(size_type pos) const n
 /**
  * @details Remove all elements.
  */
-template<std::movable T, typename Allocator>
-void gto::cqueue<T, Allocator>::clear() noexcept {
-  for (size_type i = 0; i < mLength; ++i) {
-    size_type index = getUncheckedIndex(i);
-    allocator_traits::destroy(mAllocator, mData + index);
-  }
+template<std::movable T, typename Allocator, typename Stats>
+void gto::cqueue<T, Allocator, Stats>::clear() noexcept {
+  destroyItems(0, mLength);
   mFront = 0;
   mLength = 0;
 }
 
+/**
+ * @details Items are destroyed by contiguous segments. Nothing is done
+ *          for trivially destructible types (O(1)).
+ * @param[in] pos Position of the first item to destroy.
+ * @param[in] n Number of items to destroy.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::destroyItems(size_type pos, size_type n) noexcept {
+  if constexpr (!TRIVIAL_DESTROY) {
+    if (n == 0) {
+      return;
+    }
+    size_type index = getUncheckedIndex(pos);
+    size_type len1 = std::min(n, mReserved - index);
+    for (pointer ptr = mData + index; ptr != mData + index + len1; ++ptr) {
+      allocator_traits::destroy(mAllocator, ptr);
+    }
+    for (pointer ptr = mData; ptr != mData + (n - len1); ++ptr) {
+      allocator_traits::destroy(mAllocator, ptr);
+    }
+  }
+}
+
 /**
  * @details Remove all elements and frees memory.
  */
-template<std::movable T, typename Allocator>
-void gto::cqueue<T, Allocator>::reset() noexcept {
+template<std::movable T, typename Allocator, typename Stats>
+void gto::cqueue<T, Allocator, Stats>::reset() noexcept {
   clear();
   allocator_traits::deallocate(mAllocator, mData, mReserved);
   mData = nullptr;
@@ -377,8 +708,8 @@ void gto::cqueue<T, Allocator>::reset() noexcept {
 /**
  * @details Swap content with another same-type cqueue.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::swap(cqueue &other) noexcept {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::swap(cqueue &other) noexcept {
   if (&other != this) {
     if constexpr (allocator_traits::propagate_on_container_swap::value) {
       std::swap(mAllocator, other.mAllocator);
@@ -391,6 +722,7 @@ constexpr void gto::cqueue<T, Allocator>::swap(cqueue &other) noexcept {
     std::swap(mLength, other.mLength);
     std::swap(mReserved, other.mReserved);
     std::swap(mCapacity, other.mCapacity);
+    std::swap(mStats, other.mStats);
   }
 }
 
@@ -398,8 +730,8 @@ constexpr void gto::cqueue<T, Allocator>::swap(cqueue &other) noexcept {
  * @brief Compute the new buffer size.
  * @param[in] n New queue size.
  */
-template<std::movable T, typename Allocator>
-constexpr auto gto::cqueue<T, Allocator>::getNewMemoryLength(size_type n) const noexcept {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::getNewMemoryLength(size_type n) const noexcept {
   size_type ret = (mReserved == 0 ? std::min(mCapacity, MIN_ALLOCATE) : mReserved);
   while (ret < n) {
     ret *= GROWTH_FACTOR;
@@ -412,14 +744,14 @@ constexpr auto gto::cqueue<T, Allocator>::getNewMemoryLength(size_type n) const
  * @exception std::length_error Capacity exceeded.
  * @exception ... Error throwed by move contructors.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::resizeIfRequired(size_type n) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::resizeIfRequired(size_type n) {
   if (n <= mReserved) {
     [[likely]]
     return;
   } else if (n > mCapacity) {
     [[unlikely]]
-    throw std::length_error("cqueue capacity exceeded");
+    CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
   } else {
     size_type len = getNewMemoryLength(n);
     resize(len);
@@ -431,14 +763,14 @@ constexpr void gto::cqueue<T, Allocator>::resizeIfRequired(size_type n) {
  * @exception std::length_error Capacity exceeded.
  * @exception ... Error throwed by move contructors.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::reserve(size_type n) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::reserve(size_type n) {
   if (n <= mReserved) {
     return;
   }
 
   if (n > mCapacity) {
-    throw std::length_error("cqueue capacity exceeded");
+    CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
   }
 
   resize(n);
@@ -447,14 +779,16 @@ constexpr void gto::cqueue<T, Allocator>::reserve(size_type n) {
 /**
  * @exception ... Error throwed by move contructors.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::shrink_to_fit() {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::shrink_to_fit() {
   if (mReserved == 0) {
     return;
   }
 
   if (mLength == 0) {
+    size_type reserved = mReserved;
     reset();
+    mStats.on_release(reserved);
   } else if (mLength == mReserved || mReserved <= MIN_ALLOCATE) {
     return;
   } else {
@@ -468,44 +802,58 @@ constexpr void gto::cqueue<T, Allocator>::shrink_to_fit() {
  * @see https://en.cppreference.com/w/cpp/language/exceptions#Exception_safety
  * @exception ... Error throwed by move contructors.
  */
-template<std::movable T, typename Allocator>
-void gto::cqueue<T, Allocator>::resize(size_type len)
+template<std::movable T, typename Allocator, typename Stats>
+void gto::cqueue<T, Allocator, Stats>::resize(size_type len)
 {
   pointer tmp = allocator_traits::allocate(mAllocator, len);
 
-  if constexpr (std::is_nothrow_move_constructible<T>::value) {
+  // content = [seg2, gap, seg1] or [gap, seg1, gap]
+  size_type len1 = std::min(mLength, mReserved - mFront);
+  size_type len2 = mLength - len1;
+
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    // copy bytes from mData to tmp
+    if (len1 > 0) {
+      std::memcpy(static_cast<void *>(tmp), mData + mFront, len1 * sizeof(T));
+    }
+    if (len2 > 0) {
+      std::memcpy(static_cast<void *>(tmp + len1), mData, len2 * sizeof(T));
+    }
+  }
+  else if constexpr (std::is_nothrow_move_constructible<T>::value) {
     // move elements from mData to tmp
-    for (size_type i = 0; i < mLength; ++i) {
-      size_type index = getUncheckedIndex(i);
-      allocator_traits::construct(mAllocator, tmp + i, std::move(mData[index]));
+    for (size_type i = 0; i < len1; ++i) {
+      allocator_traits::construct(mAllocator, tmp + i, std::move(mData[mFront + i]));
+    }
+    for (size_type i = 0; i < len2; ++i) {
+      allocator_traits::construct(mAllocator, tmp + len1 + i, std::move(mData[i]));
     }
   }
   else {
     // copy elements from mData to tmp
     size_type pos = 0;
-    try {
+    CQUEUE_TRY {
       for (pos = 0; pos < mLength; ++pos) {
-        size_type index = getUncheckedIndex(pos);
+        size_type index = (pos < len1 ? mFront + pos : pos - len1);
         allocator_traits::construct(mAllocator, tmp + pos, mData[index]);
       }
-    } catch (...) {
+    } CQUEUE_CATCH_ALL {
       while (pos-- > 0) {
         allocator_traits::destroy(mAllocator, tmp + pos);
       }
       allocator_traits::deallocate(mAllocator, tmp, len);
-      throw;
+      CQUEUE_RETHROW;
     }
   }
 
   // destroy mData elements
-  for (size_type j = 0; j < mLength; ++j) {
-    size_type index = getUncheckedIndex(j);
-    allocator_traits::destroy(mAllocator, mData + index);
-  }
+  destroyItems(0, mLength);
 
   // deallocate mData
   allocator_traits::deallocate(mAllocator, mData, mReserved);
 
+  mStats.on_resize(mReserved, len, mLength * sizeof(T));
+
   // assign new content
   mData = tmp;
   mReserved = len;
@@ -516,50 +864,54 @@ void gto::cqueue<T, Allocator>::resize(size_type len)
  * @param[in] val Value to add.
  * @exception std::length_error Number of values exceed queue capacity.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::push_back(const T &val) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::push_back(const T &val) {
   resizeIfRequired(mLength + 1);
   size_type index = getUncheckedIndex(mLength);
   allocator_traits::construct(mAllocator, mData + index, val);
   ++mLength;
+  mStats.on_push(mLength);
 }
 
 /**
  * @param[in] val Value to add.
  * @exception std::length_error Number of values exceed queue capacity.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::push_back(T &&val) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::push_back(T &&val) {
   resizeIfRequired(mLength + 1);
   size_type index = getUncheckedIndex(mLength);
   allocator_traits::construct(mAllocator, mData + index, std::move(val));
   ++mLength;
+  mStats.on_push(mLength);
 }
 
 /**
  * @param[in] val Value to add.
  * @exception std::length_error Number of values exceed queue capacity.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::push_front(const T &val) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::push_front(const T &val) {
   resizeIfRequired(mLength + 1);
   size_type index = (mLength == 0 ? 0 : (mFront == 0 ? mReserved : mFront) - 1);
   allocator_traits::construct(mAllocator, mData + index, val);
   mFront = index;
   ++mLength;
+  mStats.on_push(mLength);
 }
 
 /**
  * @param[in] val Value to add.
  * @exception std::length_error Number of values exceed queue capacity.
  */
-template<std::movable T, typename Allocator>
-constexpr void gto::cqueue<T, Allocator>::push_front(T &&val) {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::push_front(T &&val) {
   resizeIfRequired(mLength + 1);
   size_type index = (mLength == 0 ? 0 : (mFront == 0 ? mReserved : mFront) - 1);
   allocator_traits::construct(mAllocator, mData + index, std::move(val));
   mFront = index;
   ++mLength;
+  mStats.on_push(mLength);
 }
 
 /**
@@ -567,13 +919,14 @@ constexpr void gto::cqueue<T, Allocator>::push_front(T &&val) {
  * @return Reference to emplaced object.
  * @exception std::length_error Number of values exceed queue capacity.
  */
-template<std::movable T, typename Allocator>
+template<std::movable T, typename Allocator, typename Stats>
 template <class... Args>
-constexpr auto gto::cqueue<T, Allocator>::emplace_back(Args&&... args) -> reference {
+constexpr auto gto::cqueue<T, Allocator, Stats>::emplace_back(Args&&... args) -> reference {
   resizeIfRequired(mLength + 1);
   size_type index = getUncheckedIndex(mLength);
   allocator_traits::construct(mAllocator, mData + index, std::forward<Args>(args)...);
   ++mLength;
+  mStats.on_push(mLength);
   return mData[index];
 }
 
@@ -582,14 +935,15 @@ constexpr auto gto::cqueue<T, Allocator>::emplace_back(Args&&... args) -> refere
  * @return Reference to emplaced object.
  * @exception std::length_error Number of values exceed queue capacity.
  */
-template<std::movable T, typename Allocator>
+template<std::movable T, typename Allocator, typename Stats>
 template <class... Args>
-constexpr auto gto::cqueue<T, Allocator>::emplace_front(Args&&... args) -> reference {
+constexpr auto gto::cqueue<T, Allocator, Stats>::emplace_front(Args&&... args) -> reference {
   resizeIfRequired(mLength + 1);
   size_type index = (mLength == 0 ? 0 : (mFront == 0 ? mReserved : mFront) - 1);
   allocator_traits::construct(mAllocator, mData + index, std::forward<Args>(args)...);
   mFront = index;
   ++mLength;
+  mStats.on_push(mLength);
   return mData[index];
 }
 
@@ -597,12 +951,15 @@ constexpr auto gto::cqueue<T, Allocator>::emplace_front(Args&&... args) -> refer
  * @return true = an element was erased, false = no elements in the queue.
  * @exception std::out_of_range No elements to pop.
  */
-template<std::movable T, typename Allocator>
-constexpr typename gto::cqueue<T, Allocator>::value_type gto::cqueue<T, Allocator>::pop_front() {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr typename gto::cqueue<T, Allocator, Stats>::value_type gto::cqueue<T, Allocator, Stats>::pop_front() {
   value_type ret{std::move(front())};
-  allocator_traits::destroy(mAllocator, mData + mFront);
+  if constexpr (!TRIVIAL_DESTROY) {
+    allocator_traits::destroy(mAllocator, mData + mFront);
+  }
   mFront = getUncheckedIndex(1);
   --mLength;
+  mStats.on_pop();
   return ret;
 }
 
@@ -610,11 +967,631 @@ constexpr typename gto::cqueue<T, Allocator>::value_type gto::cqueue<T, Allocato
  * @return true = an element was erased, false = no elements in the queue.
  * @exception std::out_of_range No elements to pop.
  */
-template<std::movable T, typename Allocator>
-constexpr typename gto::cqueue<T, Allocator>::value_type gto::cqueue<T, Allocator>::pop_back() {
+template<std::movable T, typename Allocator, typename Stats>
+constexpr typename gto::cqueue<T, Allocator, Stats>::value_type gto::cqueue<T, Allocator, Stats>::pop_back() {
   value_type ret{std::move(back())};
-  size_type index = getUncheckedIndex(mLength - 1);
-  allocator_traits::destroy(mAllocator, mData + index);
+  if constexpr (!TRIVIAL_DESTROY) {
+    allocator_traits::destroy(mAllocator, mData + getUncheckedIndex(mLength - 1));
+  }
   --mLength;
+  mStats.on_pop();
   return ret;
 }
+
+/**
+ * @param[in] args Arguments of the new item.
+ * @return Pointer to emplaced object, nullptr if capacity exceeded.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template <class... Args>
+constexpr auto gto::cqueue<T, Allocator, Stats>::try_emplace_back(Args&&... args) -> pointer {
+  if (mLength == mCapacity) {
+    return nullptr;
+  }
+  return &emplace_back(std::forward<Args>(args)...);
+}
+
+/**
+ * @param[in] args Arguments of the new item.
+ * @return Pointer to emplaced object, nullptr if capacity exceeded.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template <class... Args>
+constexpr auto gto::cqueue<T, Allocator, Stats>::try_emplace_front(Args&&... args) -> pointer {
+  if (mLength == mCapacity) {
+    return nullptr;
+  }
+  return &emplace_front(std::forward<Args>(args)...);
+}
+
+/**
+ * @param[out] val Removed element (unchanged if queue is empty).
+ * @return true = an element was removed, false = no elements in the queue.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr bool gto::cqueue<T, Allocator, Stats>::try_pop_front(T &val) {
+  if (mLength == 0) {
+    return false;
+  }
+  val = std::move(mData[mFront]);
+  if constexpr (!TRIVIAL_DESTROY) {
+    allocator_traits::destroy(mAllocator, mData + mFront);
+  }
+  mFront = getUncheckedIndex(1);
+  --mLength;
+  mStats.on_pop();
+  return true;
+}
+
+/**
+ * @param[out] val Removed element (unchanged if queue is empty).
+ * @return true = an element was removed, false = no elements in the queue.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr bool gto::cqueue<T, Allocator, Stats>::try_pop_back(T &val) {
+  if (mLength == 0) {
+    return false;
+  }
+  size_type index = getUncheckedIndex(mLength - 1);
+  val = std::move(mData[index]);
+  if constexpr (!TRIVIAL_DESTROY) {
+    allocator_traits::destroy(mAllocator, mData + index);
+  }
+  --mLength;
+  mStats.on_pop();
+  return true;
+}
+
+/**
+ * @return Removed element, or nullopt if there are no elements in the queue.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::try_pop_front() -> std::optional<value_type> {
+  if (mLength == 0) {
+    return std::nullopt;
+  }
+  return pop_front();
+}
+
+/**
+ * @return Removed element, or nullopt if there are no elements in the queue.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::try_pop_back() -> std::optional<value_type> {
+  if (mLength == 0) {
+    return std::nullopt;
+  }
+  return pop_back();
+}
+
+/**
+ * @details Ensures room for n new elements and returns the (at most two)
+ *          contiguous segments of uninitialized slots following the back
+ *          element, in order. Construct the new elements in place (eg.
+ *          std::construct_at) and publish them calling commit_back().
+ * @param[in] n Number of slots.
+ * @return Uninitialized slots (second segment empty when not wrapped).
+ * @exception std::length_error Number of values exceed queue capacity.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::prepare_back(size_type n) -> segments {
+  if (n > mCapacity - mLength) {
+    CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
+  }
+  resizeIfRequired(mLength + n);
+  if (n == 0) {
+    return {};
+  }
+  size_type index = getUncheckedIndex(mLength);
+  size_type len1 = std::min(n, mReserved - index);
+  return {std::span<value_type>{mData + index, len1}, std::span<value_type>{mData, n - len1}};
+}
+
+/**
+ * @details Elements are appended without copy. The first n slots returned by
+ *          prepare_back() must have been constructed.
+ * @param[in] n Number of constructed slots.
+ * @exception std::length_error Number of slots exceeds the reserved memory.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::commit_back(size_type n) {
+  if (n > mReserved - mLength) {
+    CQUEUE_THROW(std::length_error("cqueue commit exceeds reserved memory"));
+  }
+  mLength += n;
+  mStats.on_push(mLength, n);
+}
+
+/**
+ * @details Ensures room for n new elements and returns the (at most two)
+ *          contiguous segments of uninitialized slots preceding the front
+ *          element, in order. Construct the new elements in place and
+ *          publish them calling commit_front().
+ * @param[in] n Number of slots.
+ * @return Uninitialized slots (second segment empty when not wrapped).
+ * @exception std::length_error Number of values exceed queue capacity.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::prepare_front(size_type n) -> segments {
+  if (n > mCapacity - mLength) {
+    CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
+  }
+  resizeIfRequired(mLength + n);
+  if (n == 0) {
+    return {};
+  }
+  size_type index = getUncheckedIndex(mReserved - n);
+  size_type len1 = std::min(n, mReserved - index);
+  return {std::span<value_type>{mData + index, len1}, std::span<value_type>{mData, n - len1}};
+}
+
+/**
+ * @details Elements are prepended without copy. The last n slots returned by
+ *          prepare_front() (those adjacent to the front element) must have
+ *          been constructed.
+ * @param[in] n Number of constructed slots.
+ * @exception std::length_error Number of slots exceeds the reserved memory.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::commit_front(size_type n) {
+  if (n > mReserved - mLength) {
+    CQUEUE_THROW(std::length_error("cqueue commit exceeds reserved memory"));
+  }
+  if (n > 0) {
+    mFront = getUncheckedIndex(mReserved - n);
+  }
+  mLength += n;
+  mStats.on_push(mLength, n);
+}
+
+/**
+ * @details Gives direct access to a run of elements without linearizing
+ *          the buffer. Segments are valid until next modification.
+ * @param[in] pos Position of the first element.
+ * @param[in] n Number of elements.
+ * @return Elements in order (second segment empty when not wrapped).
+ * @exception std::out_of_range Range exceeds queue size.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::spans(size_type pos, size_type n) -> segments {
+  if (pos > mLength || n > mLength - pos) {
+    CQUEUE_THROW(std::out_of_range("cqueue access out-of-range"));
+  }
+  if (n == 0) {
+    return {};
+  }
+  size_type index = getUncheckedIndex(pos);
+  size_type len1 = std::min(n, mReserved - index);
+  return {std::span<value_type>{mData + index, len1}, std::span<value_type>{mData, n - len1}};
+}
+
+/**
+ * @details Elements are moved by contiguous runs (memcpy for trivially
+ *          copyable types) and removed from this queue with a single index
+ *          update. When dest is empty and all elements are moved, the
+ *          buffer is handed over in O(1) if allocators are equal and the
+ *          dest capacity allows it.
+ *          Types not nothrow-move-constructible are moved one by one.
+ * @param[in] dest Destination queue (distinct from this one).
+ * @param[in] n Maximum number of elements to move.
+ * @return Number of moved elements (limited by size and dest capacity).
+ * @exception ... Error throwed by move contructors or memory allocation.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::transfer_front(cqueue &dest, size_type n) -> size_type {
+  if (&dest == this) {
+    return 0;
+  }
+
+  n = std::min({n, mLength, dest.mCapacity - dest.mLength});
+
+  if (n == 0) {
+    return 0;
+  }
+
+  // steal buffer
+  bool sameAllocator = (allocator_traits::is_always_equal::value || mAllocator == dest.mAllocator);
+  if (n == mLength && dest.mLength == 0 && sameAllocator &&
+      mReserved <= dest.mCapacity && dest.mReserved <= mCapacity) {
+    std::swap(mData, dest.mData);
+    std::swap(mFront, dest.mFront);
+    std::swap(mLength, dest.mLength);
+    std::swap(mReserved, dest.mReserved);
+    dest.mStats.on_push(dest.mLength, n);
+    mStats.on_pop(n);
+    return n;
+  }
+
+  if constexpr (!std::is_nothrow_move_constructible<T>::value) {
+    return consume_front(n, [&dest](T &val) { dest.emplace_back(std::move(val)); });
+  } else {
+    auto [dst1, dst2] = dest.prepare_back(n);
+    size_type len1 = std::min(n, mReserved - mFront);
+    std::span<value_type> src1{mData + mFront, len1};
+    std::span<value_type> src2{mData, n - len1};
+
+    // copy runs where both source and destination are contiguous
+    while (!src1.empty()) {
+      size_type len = std::min(src1.size(), dst1.size());
+      if constexpr (std::is_trivially_copyable<T>::value) {
+        std::memcpy(static_cast<void *>(dst1.data()), src1.data(), len * sizeof(T));
+      } else {
+        for (size_type i = 0; i < len; ++i) {
+          allocator_traits::construct(dest.mAllocator, dst1.data() + i, std::move(src1[i]));
+        }
+      }
+      src1 = src1.subspan(len);
+      dst1 = dst1.subspan(len);
+      if (src1.empty()) {
+        std::swap(src1, src2);
+      }
+      if (dst1.empty()) {
+        std::swap(dst1, dst2);
+      }
+    }
+
+    dest.commit_back(n);
+    destroyItems(0, n);
+    mFront = getUncheckedIndex(n);
+    mLength -= n;
+    mStats.on_pop(n);
+    return n;
+  }
+}
+
+/**
+ * @details Calls fn(T &) on each front element, walking the contiguous
+ *          segments of the buffer, and then removes the processed run with
+ *          a single index update. This avoids the move and destruction of
+ *          a temporary per element done by pop_front().
+ *          If fn throws, the elements processed before are removed and the
+ *          failing one remains at the front.
+ *          fn must not modify the queue.
+ * @param[in] n Maximum number of elements to consume.
+ * @param[in] fn Function called with a reference to each element.
+ * @return Number of consumed elements.
+ * @exception ... Error throwed by fn.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template<typename Fn>
+constexpr auto gto::cqueue<T, Allocator, Stats>::consume_front(size_type n, Fn fn) -> size_type {
+  n = std::min(n, mLength);
+
+  size_type done = 0;
+  auto release = [this, &done]() {
+    destroyItems(0, done);
+    mFront = getUncheckedIndex(done);
+    mLength -= done;
+    mStats.on_pop(done);
+  };
+
+  CQUEUE_TRY {
+    size_type len1 = std::min(n, mReserved - mFront);
+    for (pointer ptr = mData + mFront; done < len1; ++ptr, ++done) {
+      fn(*ptr);
+    }
+    for (pointer ptr = mData; done < n; ++ptr, ++done) {
+      fn(*ptr);
+    }
+  } CQUEUE_CATCH_ALL {
+    release();
+    CQUEUE_RETHROW;
+  }
+
+  release();
+  return n;
+}
+
+/**
+ * @details After this call mFront = 0 and items are stored contiguously
+ *          in [0, size()). Segments are joined by moving the first one
+ *          down over the gap and then rotating the buffer in place (O(n)).
+ *          Types not nothrow-move-constructible are relocated to a new
+ *          buffer instead (strong exception guarantee).
+ * @return Contiguous view of the queue content (valid until next modification).
+ * @exception ... Error throwed by move contructors.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::linearize() -> std::span<value_type>
+{
+  if (mFront == 0) {
+    return {mData, mLength};
+  }
+
+  if (mLength == 0) {
+    mFront = 0;
+    return {mData, mLength};
+  }
+
+  if constexpr (!std::is_nothrow_move_constructible<T>::value) {
+    resize(mReserved);
+    return {mData, mLength};
+  }
+
+  // content = [seg2, gap, seg1] or [gap, seg1, gap]
+  size_type len1 = std::min(mLength, mReserved - mFront);
+  size_type len2 = mLength - len1;
+  size_type shift = mFront - len2;
+
+  // move seg1 down, just after seg2
+  if (shift == 0) {
+    // full queue, nothing to move
+  } else if constexpr (std::is_trivially_copyable<T>::value) {
+    std::memmove(static_cast<void *>(mData + len2), mData + mFront, len1 * sizeof(T));
+  } else {
+    for (size_type i = 0; i < len1; ++i) {
+      if (i < shift) {
+        allocator_traits::construct(mAllocator, mData + len2 + i, std::move(mData[mFront + i]));
+      } else {
+        mData[len2 + i] = std::move(mData[mFront + i]);
+      }
+    }
+    if constexpr (!TRIVIAL_DESTROY) {
+      for (size_type i = std::max(len1, shift) - shift; i < len1; ++i) {
+        allocator_traits::destroy(mAllocator, mData + mFront + i);
+      }
+    }
+  }
+
+  // content = [seg2, seg1, gap]
+  std::rotate(mData, mData + len2, mData + mLength);
+  mFront = 0;
+  return {mData, mLength};
+}
+
+/**
+ * @param[in] it Iterator to convert.
+ * @return Position of the iterator (0 <= pos <= size()).
+ * @exception std::out_of_range Invalid iterator.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::getPosition(const_iterator it) const -> size_type {
+  difference_type pos = it - cbegin();
+  if (pos < 0 || static_cast<size_type>(pos) > mLength) {
+    CQUEUE_THROW(std::out_of_range("cqueue access out-of-range"));
+  }
+  return static_cast<size_type>(pos);
+}
+
+/**
+ * @details Destination items must be constructed (except for trivially
+ *          copyable types). Overlapping ranges are allowed. Trivially
+ *          copyable types are moved by contiguous chunks using memmove.
+ * @param[in] src Position of the first item to move.
+ * @param[in] dst Position where the first item is moved.
+ * @param[in] n Number of items to move.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr void gto::cqueue<T, Allocator, Stats>::moveItems(size_type src, size_type dst, size_type n) {
+  if (n == 0 || src == dst) {
+    return;
+  }
+
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (dst < src) {
+      for (size_type done = 0; done < n; ) {
+        size_type from = getUncheckedIndex(src + done);
+        size_type to = getUncheckedIndex(dst + done);
+        size_type len = std::min({n - done, mReserved - from, mReserved - to});
+        std::memmove(static_cast<void *>(mData + to), mData + from, len * sizeof(T));
+        done += len;
+      }
+    } else {
+      for (size_type left = n; left > 0; ) {
+        size_type from = getUncheckedIndex(src + left - 1) + 1;
+        size_type to = getUncheckedIndex(dst + left - 1) + 1;
+        size_type len = std::min({left, from, to});
+        std::memmove(static_cast<void *>(mData + to - len), mData + from - len, len * sizeof(T));
+        left -= len;
+      }
+    }
+  } else {
+    if (dst < src) {
+      for (size_type i = 0; i < n; ++i) {
+        mData[getUncheckedIndex(dst + i)] = std::move(mData[getUncheckedIndex(src + i)]);
+      }
+    } else {
+      for (size_type i = n; i-- > 0; ) {
+        mData[getUncheckedIndex(dst + i)] = std::move(mData[getUncheckedIndex(src + i)]);
+      }
+    }
+  }
+}
+
+/**
+ * @details Moves the shorter side (front or back) of the queue.
+ *          Trivially copyable types are shifted with memmove. Other
+ *          types are appended at the shorter end and rotated into place.
+ * @param[in] pos Position of the first inserted item (0 <= pos <= size()).
+ * @param[in] n Number of items to insert.
+ * @param[in] fill Function constructing an item in the given address.
+ * @exception std::length_error Number of values exceed queue capacity.
+ * @exception ... Error throwed by constructors.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template<typename Fill>
+constexpr void gto::cqueue<T, Allocator, Stats>::insertItems(size_type pos, size_type n, Fill fill) {
+  if (n == 0) {
+    return;
+  }
+
+  if (n > mCapacity - mLength) {
+    CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
+  }
+
+  resizeIfRequired(mLength + n);
+
+  bool atBack = (pos >= mLength - pos);
+
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (atBack) {
+      size_type len = mLength;
+      mLength += n;
+      moveItems(pos, pos + n, len - pos);
+    } else {
+      mFront = getUncheckedIndex(mReserved - n);
+      mLength += n;
+      moveItems(n, 0, pos);
+    }
+    for (size_type i = 0; i < n; ++i) {
+      fill(mData + getUncheckedIndex(pos + i));
+    }
+    mStats.on_push(mLength, n);
+  } else {
+    size_type len = mLength;
+    for (size_type i = 0; i < n; ++i) {
+      size_type index = (atBack ? getUncheckedIndex(mLength) : (mLength == 0 ? 0 : (mFront == 0 ? mReserved : mFront) - 1));
+      fill(mData + index);
+      mFront = (atBack ? mFront : index);
+      ++mLength;
+      mStats.on_push(mLength);
+    }
+    auto first = begin();
+    auto d = [](size_type x) { return static_cast<difference_type>(x); };
+    if (atBack) {
+      std::rotate(first + d(pos), first + d(len), end());
+    } else {
+      std::reverse(first, first + d(n));
+      std::rotate(first, first + d(n), first + d(n + pos));
+    }
+  }
+}
+
+/**
+ * @param[in] pos Iterator before which the element is inserted.
+ * @param[in] val Value to insert.
+ * @return Iterator pointing to the inserted value.
+ * @exception std::out_of_range Invalid iterator.
+ * @exception std::length_error Number of values exceed queue capacity.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::insert(const_iterator pos, T &&val) -> iterator {
+  size_type index = getPosition(pos);
+  insertItems(index, 1, [&](pointer ptr) {
+    allocator_traits::construct(mAllocator, ptr, std::move(val));
+  });
+  return iterator(this, static_cast<difference_type>(index));
+}
+
+/**
+ * @param[in] pos Iterator before which the elements are inserted.
+ * @param[in] n Number of copies to insert.
+ * @param[in] val Value to insert (can be a queue element).
+ * @return Iterator pointing to the first inserted value.
+ * @exception std::out_of_range Invalid iterator.
+ * @exception std::length_error Number of values exceed queue capacity.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::insert(const_iterator pos, size_type n, const T &val) -> iterator {
+  size_type index = getPosition(pos);
+  std::less<const T *> less;
+  if (mData != nullptr && !less(&val, mData) && less(&val, mData + mReserved)) {
+    // val is moved or invalidated when the queue is modified
+    value_type tmp{val};
+    insertItems(index, n, [&](pointer ptr) { allocator_traits::construct(mAllocator, ptr, tmp); });
+  } else {
+    insertItems(index, n, [&](pointer ptr) { allocator_traits::construct(mAllocator, ptr, val); });
+  }
+  return iterator(this, static_cast<difference_type>(index));
+}
+
+/**
+ * @param[in] pos Iterator before which the elements are inserted.
+ * @param[in] first Iterator to the first element to insert.
+ * @param[in] last Iterator to the element following the last element to insert.
+ * @return Iterator pointing to the first inserted value.
+ * @exception std::out_of_range Invalid iterator.
+ * @exception std::length_error Number of values exceed queue capacity.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+template<std::input_iterator InputIt>
+constexpr auto gto::cqueue<T, Allocator, Stats>::insert(const_iterator pos, InputIt first, InputIt last) -> iterator {
+  size_type index = getPosition(pos);
+  if constexpr (std::forward_iterator<InputIt>) {
+    auto n = static_cast<size_type>(std::distance(first, last));
+    insertItems(index, n, [&](pointer ptr) { allocator_traits::construct(mAllocator, ptr, *first++); });
+  } else {
+    cqueue tmp(0, mAllocator);
+    for (; first != last; ++first) {
+      tmp.push_back(*first);
+    }
+    insert(pos, std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+  }
+  return iterator(this, static_cast<difference_type>(index));
+}
+
+/**
+ * @details Moves the shorter side (front or back) of the queue.
+ * @param[in] first Iterator to the first element to remove.
+ * @param[in] last Iterator to the element following the last element to remove.
+ * @return Iterator following the last removed element.
+ * @exception std::out_of_range Invalid iterator.
+ */
+template<std::movable T, typename Allocator, typename Stats>
+constexpr auto gto::cqueue<T, Allocator, Stats>::erase(const_iterator first, const_iterator last) -> iterator {
+  size_type pos1 = getPosition(first);
+  size_type pos2 = getPosition(last);
+
+  if (pos2 <= pos1) {
+    return iterator(this, static_cast<difference_type>(pos1));
+  }
+
+  size_type n = pos2 - pos1;
+
+  if (pos1 < mLength - pos2) {
+    moveItems(0, n, pos1);
+    destroyItems(0, n);
+    mFront = getUncheckedIndex(n);
+  } else {
+    moveItems(pos2, pos1, mLength - pos2);
+    destroyItems(mLength - n, n);
+  }
+
+  mLength -= n;
+  mStats.on_pop(n);
+  return iterator(this, static_cast<difference_type>(pos1));
+}
+
+namespace gto {
+
+/**
+ * @brief Sort the queue content.
+ * @details Linearizes the buffer and sorts a raw pointer range,
+ *          avoiding checked iterators and index computation.
+ * @param[in] queue Queue to sort.
+ * @param[in] comp Comparison function object.
+ */
+template<std::movable T, typename Allocator, typename Stats, typename Compare = std::less<>>
+constexpr void sort(cqueue<T, Allocator, Stats> &queue, Compare comp = Compare()) {
+  auto content = queue.linearize();
+  std::sort(content.begin(), content.end(), comp);
+}
+
+/**
+ * @brief Sort the queue content preserving the order of equivalent elements.
+ * @param[in] queue Queue to sort.
+ * @param[in] comp Comparison function object.
+ */
+template<std::movable T, typename Allocator, typename Stats, typename Compare = std::less<>>
+void stable_sort(cqueue<T, Allocator, Stats> &queue, Compare comp = Compare()) {
+  auto content = queue.linearize();
+  std::stable_sort(content.begin(), content.end(), comp);
+}
+
+/**
+ * @brief Partially sort the queue content (see std::nth_element).
+ * @param[in] queue Queue to sort.
+ * @param[in] n Position of the element placed in its sorted position.
+ * @param[in] comp Comparison function object.
+ * @exception std::out_of_range Invalid position.
+ */
+template<std::movable T, typename Allocator, typename Stats, typename Compare = std::less<>>
+constexpr void nth_element(cqueue<T, Allocator, Stats> &queue, std::size_t n, Compare comp = Compare()) {
+  if (n >= queue.size()) {
+    CQUEUE_THROW(std::out_of_range("cqueue access out-of-range"));
+  }
+  auto content = queue.linearize();
+  std::nth_element(content.begin(), content.begin() + static_cast<std::ptrdiff_t>(n), content.end(), comp);
+}
+
+} // namespace gto
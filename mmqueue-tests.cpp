@@ -0,0 +1,266 @@
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "catch.hpp"
+#include "mmqueue.hpp"
+
+using gto::mmqueue;
+using gto::mmqueue_policy;
+
+namespace {
+
+struct job {
+  std::uint64_t id;
+  char name[16];
+};
+
+std::string temp_path(const char *name) {
+  return "/tmp/cqueue-tests-" + std::to_string(::getpid()) + "-" + name;
+}
+
+} // unnamed namespace
+
+TEST_CASE("mmqueue") {
+
+  SECTION("create") {
+    std::string path = temp_path("create");
+    std::remove(path.c_str());
+    {
+      auto queue = mmqueue<int>::open(path, 100);
+      CHECK(queue.capacity() == 128);
+      CHECK(queue.size() == 0);
+      CHECK(queue.empty());
+      CHECK(!queue.full());
+      CHECK(!queue.try_pop().has_value());
+      CHECK_THROWS_AS(queue.pop(), std::out_of_range);
+      CHECK_THROWS_AS(queue.front(), std::out_of_range);
+    }
+    CHECK_THROWS_AS(mmqueue<int>::open(temp_path("nodir/x"), 10), std::system_error);
+    std::remove(path.c_str());
+    CHECK_THROWS_AS(mmqueue<int>::open(path, 0), std::length_error);
+    std::remove(path.c_str());
+  }
+
+  SECTION("interrupted create") {
+    std::string path = temp_path("interrupted");
+    auto pagesize = static_cast<off_t>(::sysconf(_SC_PAGESIZE));
+    auto write_file = [&path](const void *data, std::size_t len, off_t size) {
+      std::FILE *file = std::fopen(path.c_str(), "w");
+      REQUIRE(file != nullptr);
+      std::fwrite(data, 1, len, file);
+      std::fclose(file);
+      REQUIRE(::truncate(path.c_str(), size) == 0);
+    };
+    // crash after ftruncate, before writing the header
+    write_file("", 0, pagesize + 16 * static_cast<off_t>(sizeof(int)));
+    {
+      auto queue = mmqueue<int>::open(path, 16);
+      CHECK(queue.capacity() == 16);
+      CHECK(queue.empty());
+      queue.push(7);
+    }
+    {
+      auto queue = mmqueue<int>::open(path, 64);
+      CHECK(queue.capacity() == 16);
+      CHECK(queue.pop() == 7);
+    }
+    // crash after writing the header, before writing magic
+    std::uint64_t partial[6] = {0, sizeof(int), 32, static_cast<std::uint64_t>(pagesize), 0, 0};
+    write_file(partial, sizeof(partial), pagesize + 32 * static_cast<off_t>(sizeof(int)));
+    CHECK(mmqueue<int>::open(path, 20).capacity() == 32);
+    // zero-filled file not matching the requested capacity (eg. preallocated)
+    write_file("", 0, 3 * pagesize);
+    CHECK_THROWS_AS(mmqueue<int>::open(path, 16), std::invalid_argument);
+    CHECK(std::filesystem::file_size(path) == static_cast<std::uintmax_t>(3 * pagesize));
+    // zero magic, foreign data
+    std::uint64_t foreign[6] = {0, 1, 2, 3, 4, 5};
+    write_file(foreign, sizeof(foreign), pagesize + 16 * static_cast<off_t>(sizeof(int)));
+    CHECK_THROWS_AS(mmqueue<int>::open(path, 16), std::invalid_argument);
+    // non-queue file
+    {
+      std::FILE *file = std::fopen(path.c_str(), "w");
+      REQUIRE(file != nullptr);
+      std::fputs("not a queue, not a queue, not a queue, not a queue, not a queue", file);
+      std::fclose(file);
+    }
+    CHECK_THROWS_AS(mmqueue<int>::open(path, 16), std::invalid_argument);
+    std::remove(path.c_str());
+  }
+
+  SECTION("single opener") {
+    std::string path = temp_path("single");
+    std::remove(path.c_str());
+    {
+      auto queue = mmqueue<int>::open(path, 16);
+      try {
+        mmqueue<int>::open(path, 16);
+        FAIL("second open succeeded");
+      }
+      catch (const std::system_error &e) {
+        CHECK(e.code().value() == EWOULDBLOCK);
+      }
+      // lock moves with the queue
+      auto moved = std::move(queue);
+      CHECK_THROWS_AS(mmqueue<int>::open(path, 16), std::system_error);
+    }
+    CHECK(mmqueue<int>::open(path, 16).capacity() == 16);
+    std::remove(path.c_str());
+  }
+
+  SECTION("concurrent create") {
+    std::string path = temp_path("concurrent");
+    std::remove(path.c_str());
+    constexpr int NUM_PROCESSES = 4;
+    std::vector<pid_t> pids;
+    for (int i = 0; i < NUM_PROCESSES; i++) {
+      pid_t pid = ::fork();
+      REQUIRE(pid >= 0);
+      if (pid == 0) {
+        // each process creates the file with a different capacity
+        for (;;) {
+          try {
+            auto queue = mmqueue<std::uint64_t>::open(path, 8U << i);
+            ::_exit(queue.capacity() >= 8 ? 0 : 1);
+          }
+          catch (const std::system_error &e) {
+            // opened by another process
+            if (e.code().value() != EWOULDBLOCK) ::_exit(2);
+            std::this_thread::yield();
+          }
+          catch (...) {
+            ::_exit(3);
+          }
+        }
+      }
+      pids.push_back(pid);
+    }
+    for (pid_t pid : pids) {
+      int status = -1;
+      ::waitpid(pid, &status, 0);
+      CHECK(WIFEXITED(status));
+      CHECK(WEXITSTATUS(status) == 0);
+    }
+    // initialized once, consistent size
+    auto queue = mmqueue<std::uint64_t>::open(path, 1);
+    CHECK(queue.empty());
+    CHECK(static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) + queue.capacity() * sizeof(std::uint64_t) == static_cast<std::size_t>(std::filesystem::file_size(path)));
+    std::remove(path.c_str());
+  }
+
+  SECTION("push-pop") {
+    std::string path = temp_path("push-pop");
+    std::remove(path.c_str());
+    auto queue = mmqueue<int>::open(path, 4);
+    CHECK(queue.try_push(1));
+    queue.push(2);
+    queue.push(3);
+    queue.push(4);
+    CHECK(queue.full());
+    CHECK(!queue.try_push(5));
+    CHECK_THROWS_AS(queue.push(5), std::length_error);
+    CHECK(queue.front() == 1);
+    CHECK(queue.back() == 4);
+    CHECK(queue[2] == 3);
+    CHECK_THROWS_AS(queue[4], std::out_of_range);
+    CHECK(queue.pop() == 1);
+    CHECK(queue.try_pop() == 2);
+    queue.push(5);
+    queue.push(6);
+    // wrapped
+    for (int i = 3; i <= 6; i++) {
+      CHECK(queue.pop() == i);
+    }
+    CHECK(queue.empty());
+    std::remove(path.c_str());
+  }
+
+  SECTION("reopen") {
+    std::string path = temp_path("reopen");
+    std::remove(path.c_str());
+    {
+      auto queue = mmqueue<job>::open(path, 8, mmqueue_policy{0, {}});
+      for (std::uint64_t i = 0; i < 10; i++) {
+        queue.push(job{i, "job"});
+        if (i % 2 == 0) queue.pop();
+      }
+      // synced when the file was full of not synced items
+      CHECK(queue.pending() == 3);
+      // destructor syncs
+    }
+    {
+      // capacity of existing file is preserved
+      auto queue = mmqueue<job>::open(path, 1000);
+      CHECK(queue.capacity() == 8);
+      REQUIRE(queue.size() == 5);
+      CHECK(queue.front().id == 5);
+      CHECK(queue.back().id == 9);
+      CHECK(std::string(queue.back().name) == "job");
+    }
+    CHECK_THROWS_AS(mmqueue<double>::open(path, 8), std::invalid_argument);
+    std::remove(path.c_str());
+  }
+
+  SECTION("crash recovery") {
+    std::string path = temp_path("crash");
+    std::remove(path.c_str());
+    pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      auto queue = mmqueue<std::uint64_t>::open(path, 4, mmqueue_policy{0, {}});
+      queue.push(1);
+      queue.push(2);
+      queue.push(3);
+      queue.sync();
+      queue.pop();
+      queue.push(4);
+      // slot of popped item 1 not reused before syncing
+      queue.push(5);
+      queue.pop();
+      queue.push(6);
+      // crash (no destructor)
+      ::_exit(queue.size() == 4 ? 0 : 1);
+    }
+    int status = -1;
+    ::waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    auto queue = mmqueue<std::uint64_t>::open(path, 4);
+    // state synced before push(6)
+    REQUIRE(queue.size() == 3);
+    CHECK(queue[0] == 3);
+    CHECK(queue[1] == 4);
+    CHECK(queue[2] == 5);
+    std::remove(path.c_str());
+  }
+
+  SECTION("sync policy") {
+    std::string path = temp_path("policy");
+    std::remove(path.c_str());
+    auto queue1 = mmqueue<int>::open(path, 16);
+    queue1.push(1);
+    CHECK(queue1.pending() == 0);
+    std::remove(path.c_str());
+    auto queue2 = mmqueue<int>::open(path, 16, mmqueue_policy{3, {}});
+    queue2.push(1);
+    queue2.push(2);
+    CHECK(queue2.pending() == 2);
+    queue2.pop();
+    CHECK(queue2.pending() == 0);
+    std::remove(path.c_str());
+    auto queue3 = mmqueue<int>::open(path, 16, mmqueue_policy{0, std::chrono::milliseconds(10)});
+    queue3.push(1);
+    CHECK(queue3.pending() == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue3.push(2);
+    CHECK(queue3.pending() == 0);
+    std::remove(path.c_str());
+  }
+
+}
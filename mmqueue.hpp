@@ -0,0 +1,478 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief When mmqueue modifications are flushed to disk.
+ */
+struct mmqueue_policy {
+  //! Sync after n pushes/pops (0 = disabled).
+  std::size_t max_pending = 1;
+  //! Sync when the last sync is older than this (0 = disabled).
+  std::chrono::milliseconds max_delay{0};
+};
+
+/**
+ * @brief Persistent circular queue stored in a memory-mapped file.
+ *
+ * @details Items are stored in a file mapped in memory, after a small
+ *          header recording front, length and reserved. Reopening the file
+ *          recovers the queue by mapping it (no log replay).
+ *          The header only records synced states: sync() flushes the slots
+ *          written since the last sync (msync) and then writes and flushes
+ *          the header. After a crash the queue recovers the last synced
+ *          state: newer pushes are lost and newer pops are redelivered.
+ *          For this reason slots popped since the last sync are not reused
+ *          until the next sync (a full queue syncs before pushing).
+ *          The sync policy batches modifications to amortize the flush cost.
+ *          Capacity is fixed at creation and rounded up to a power of 2.
+ *
+ * @note This class is not thread-safe. A file can be opened by a single
+ *       mmqueue at a time (enforced with flock, other opens fail).
+ *
+ * @tparam T Elements type (trivially copyable).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+class mmqueue
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_reference = const T &;
+
+  private: // declarations
+
+    //! File identifier.
+    static constexpr std::uint64_t MAGIC = 0x65756575716d6d6d; // "mmmqueue"
+
+    //! File header (followed by slots).
+    struct header {
+      //! File identifier.
+      std::uint64_t magic;
+      //! Size of an item (checks T compatibility).
+      std::uint64_t slot_size;
+      //! Number of slots (power of 2).
+      std::uint64_t reserved;
+      //! Offset of the first slot from the file start.
+      std::uint64_t slots_offset;
+      //! Index of the front item (synced state).
+      std::uint64_t front;
+      //! Number of items (synced state).
+      std::uint64_t length;
+    };
+
+  private: // members
+
+    //! File descriptor.
+    int mFd = -1;
+    //! Mapping start.
+    std::byte *mAddr = nullptr;
+    //! Mapping size.
+    std::size_t mMapLength = 0;
+    //! Index of the front item.
+    size_type mFront = 0;
+    //! Number of items.
+    size_type mLength = 0;
+    //! Number of slots.
+    size_type mReserved = 0;
+    //! Number of pushes since last sync.
+    size_type mPushed = 0;
+    //! Number of pushes and pops since last sync.
+    size_type mPending = 0;
+    //! Sync policy.
+    mmqueue_policy mPolicy{};
+    //! Time of last sync.
+    std::chrono::steady_clock::time_point mLastSync{};
+
+  private: // methods
+
+    //! Constructor (takes ownership of fd).
+    mmqueue(int fd, mmqueue_policy policy) : mFd{fd}, mPolicy{policy} {}
+    //! Throw a system error.
+    [[noreturn]] static void fail(const char *what);
+    //! Round up capacity to a power of 2 (throw exception if invalid).
+    static size_type getReserved(size_type capacity, std::size_t offset);
+    //! Return the file header.
+    header & getHeader() const noexcept { return *reinterpret_cast<header *>(mAddr); }
+    //! Return the slots.
+    T * getSlots() const noexcept { return reinterpret_cast<T *>(mAddr + getHeader().slots_offset); }
+    //! Convert from pos to index.
+    size_type getIndex(size_type pos) const noexcept { return ((mFront + pos) & (mReserved - 1)); }
+    //! Flush a memory range.
+    void flush(const void *ptr, std::size_t len);
+    //! Sync if required by policy.
+    void onModified();
+
+  public: // static methods
+
+    //! Open a queue file (created if not exists).
+    static mmqueue open(const std::string &path, size_type capacity, mmqueue_policy policy = {});
+
+  public: // methods
+
+    //! Move constructor.
+    mmqueue(mmqueue &&other) noexcept { swap(other); }
+    //! Move assignment.
+    mmqueue & operator=(mmqueue &&other) noexcept { swap(other); return *this; }
+    //! Non-copyable.
+    mmqueue(const mmqueue &) = delete;
+    //! Non-copyable.
+    mmqueue & operator=(const mmqueue &) = delete;
+    //! Destructor (syncs pending modifications).
+    ~mmqueue();
+
+    //! Return queue capacity.
+    size_type capacity() const noexcept { return mReserved; }
+    //! Return the number of items.
+    size_type size() const noexcept { return mLength; }
+    //! Check if there are items in the queue.
+    [[nodiscard]] bool empty() const noexcept { return (mLength == 0); }
+    //! Check if the queue is full.
+    [[nodiscard]] bool full() const noexcept { return (mLength == mReserved); }
+    //! Number of pushes and pops not synced.
+    size_type pending() const noexcept { return mPending; }
+    //! Swap content.
+    void swap(mmqueue &other) noexcept;
+
+    //! Returns a const reference to the element at position n.
+    const_reference operator[](size_type n) const;
+    //! Return the first element.
+    const_reference front() const { return operator[](0); }
+    //! Return the last element.
+    const_reference back() const { return operator[](mLength - 1); }
+
+    //! Insert an element at the end (false if full).
+    bool try_push(const T &val);
+    //! Insert an element at the end.
+    void push(const T &val);
+    //! Remove the front element (nullopt if empty).
+    std::optional<T> try_pop();
+    //! Remove the front element.
+    T pop();
+
+    //! Flush modifications to disk.
+    void sync();
+};
+
+} // namespace gto
+
+/**
+ * @param[in] what Failed function.
+ * @exception std::system_error Always (aborts when exceptions are disabled).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::mmqueue<T>::fail(const char *what) {
+  CQUEUE_THROW(std::system_error(errno, std::generic_category(), what));
+  std::abort();
+}
+
+/**
+ * @param[in] capacity Requested capacity.
+ * @param[in] offset Slots offset.
+ * @return Number of slots (power of 2).
+ * @exception std::length_error Invalid capacity.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::mmqueue<T>::getReserved(size_type capacity, std::size_t offset) -> size_type {
+  if (capacity == 0 || capacity > (cqueue<T>::max_capacity() - offset) / sizeof(T) / 2) {
+    CQUEUE_THROW(std::length_error("mmqueue invalid capacity"));
+  }
+  size_type ret = 1;
+  while (ret < capacity) {
+    ret *= 2;
+  }
+  return ret;
+}
+
+/**
+ * @details Existing files keep their capacity (capacity argument ignored).
+ *          The file is locked (flock) for the queue lifetime, so it can
+ *          not be opened by another mmqueue (nor initialized twice).
+ *          The magic number is written last. A file without it is
+ *          initialized again only if it looks like a crash while creating
+ *          it: size matching the requested capacity and header empty or
+ *          partially written by this class. Other files are rejected.
+ * @param[in] path File path.
+ * @param[in] capacity Queue capacity of a new file (rounded up to a power of 2).
+ * @param[in] policy Sync policy.
+ * @return Queue mapping the file.
+ * @exception std::system_error File can not be opened, locked (EWOULDBLOCK
+ *            if opened by another mmqueue), resized or mapped.
+ * @exception std::length_error Invalid capacity.
+ * @exception std::invalid_argument File is not a compatible queue.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::mmqueue<T>::open(const std::string &path, size_type capacity, mmqueue_policy policy) -> mmqueue {
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    fail("open");
+  }
+  mmqueue ret(fd, policy);
+
+  // released when fd is closed
+  if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+    fail("flock");
+  }
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0) {
+    fail("fstat");
+  }
+
+  std::size_t offset = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  auto len = static_cast<std::size_t>(st.st_size);
+  bool created = (len == 0);
+
+  if (!created) {
+    header hdr{};
+    if (len < sizeof(header)) {
+      CQUEUE_THROW(std::invalid_argument("mmqueue incompatible file"));
+    }
+    if (::pread(fd, &hdr, sizeof(hdr), 0) != static_cast<ssize_t>(sizeof(hdr))) {
+      fail("pread");
+    }
+    if (hdr.magic == 0) {
+      // crash while creating (after ftruncate, before writing magic)
+      size_type reserved = getReserved(capacity, offset);
+      bool blank = (hdr.slot_size == 0 && hdr.reserved == 0 && hdr.slots_offset == 0);
+      bool partial = (hdr.slot_size == sizeof(T) && hdr.reserved == reserved && hdr.slots_offset == offset);
+      if (len != offset + reserved * sizeof(T) || (!blank && !partial) || hdr.front != 0 || hdr.length != 0) {
+        CQUEUE_THROW(std::invalid_argument("mmqueue incompatible file"));
+      }
+      created = true;
+    }
+  }
+
+  if (created) {
+    len = offset + getReserved(capacity, offset) * sizeof(T);
+    if (::ftruncate(fd, static_cast<off_t>(len)) != 0) {
+      fail("ftruncate");
+    }
+  }
+
+  void *addr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    fail("mmap");
+  }
+  ret.mAddr = static_cast<std::byte *>(addr);
+  ret.mMapLength = len;
+
+  header &hdr = ret.getHeader();
+  if (created) {
+    hdr = header{0, sizeof(T), (len - offset) / sizeof(T), offset, 0, 0};
+    ret.flush(&hdr, sizeof(header));
+    hdr.magic = MAGIC;
+    ret.flush(&hdr, sizeof(header));
+  }
+  else if (hdr.magic != MAGIC || hdr.slot_size != sizeof(T) || hdr.reserved == 0 ||
+           (hdr.reserved & (hdr.reserved - 1)) != 0 || hdr.length > hdr.reserved ||
+           hdr.slots_offset < sizeof(header) || len < hdr.slots_offset + hdr.reserved * sizeof(T)) {
+    CQUEUE_THROW(std::invalid_argument("mmqueue incompatible file"));
+  }
+
+  ret.mReserved = static_cast<size_type>(hdr.reserved);
+  ret.mFront = static_cast<size_type>(hdr.front & (hdr.reserved - 1));
+  ret.mLength = static_cast<size_type>(hdr.length);
+  ret.mLastSync = std::chrono::steady_clock::now();
+  return ret;
+}
+
+/**
+ * @details Errors are ignored.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+gto::mmqueue<T>::~mmqueue() {
+  if (mAddr != nullptr) {
+    CQUEUE_TRY {
+      if (mPending > 0) {
+        sync();
+      }
+    } CQUEUE_CATCH_ALL {
+      // nothing to do
+    }
+    ::munmap(mAddr, mMapLength);
+  }
+  if (mFd >= 0) {
+    ::close(mFd);
+  }
+}
+
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::mmqueue<T>::swap(mmqueue &other) noexcept {
+  std::swap(mFd, other.mFd);
+  std::swap(mAddr, other.mAddr);
+  std::swap(mMapLength, other.mMapLength);
+  std::swap(mFront, other.mFront);
+  std::swap(mLength, other.mLength);
+  std::swap(mReserved, other.mReserved);
+  std::swap(mPushed, other.mPushed);
+  std::swap(mPending, other.mPending);
+  std::swap(mPolicy, other.mPolicy);
+  std::swap(mLastSync, other.mLastSync);
+}
+
+/**
+ * @details Range is extended to page boundaries.
+ * @param[in] ptr Start of the range (inside the mapping).
+ * @param[in] len Range length.
+ * @exception std::system_error msync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::mmqueue<T>::flush(const void *ptr, std::size_t len) {
+  if (len == 0) {
+    return;
+  }
+  auto pagesize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  auto start = static_cast<std::size_t>(static_cast<const std::byte *>(ptr) - mAddr);
+  std::size_t offset = start / pagesize * pagesize;
+  if (::msync(mAddr + offset, start + len - offset, MS_SYNC) != 0) {
+    fail("msync");
+  }
+}
+
+/**
+ * @details Flushes the slots written since the last sync and then the
+ *          header, so the synced state never refers to unwritten slots.
+ * @exception std::system_error msync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::mmqueue<T>::sync() {
+  header &hdr = getHeader();
+
+  // pushed items not popped yet
+  size_type dirty = std::min(mPushed, mLength);
+  if (dirty > 0) {
+    size_type index = getIndex(mLength - dirty);
+    size_type len1 = std::min(dirty, mReserved - index);
+    flush(getSlots() + index, len1 * sizeof(T));
+    flush(getSlots(), (dirty - len1) * sizeof(T));
+  }
+
+  hdr.front = mFront;
+  hdr.length = mLength;
+  flush(&hdr, sizeof(header));
+
+  mPushed = 0;
+  mPending = 0;
+  mLastSync = std::chrono::steady_clock::now();
+}
+
+/**
+ * @exception std::system_error msync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::mmqueue<T>::onModified() {
+  ++mPending;
+  if (mPolicy.max_pending > 0 && mPending >= mPolicy.max_pending) {
+    sync();
+  }
+  else if (mPolicy.max_delay.count() > 0 && std::chrono::steady_clock::now() - mLastSync >= mPolicy.max_delay) {
+    sync();
+  }
+}
+
+/**
+ * @param[in] n Position of the element.
+ * @return Element at position n.
+ * @exception std::out_of_range Invalid position.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::mmqueue<T>::operator[](size_type n) const -> const_reference {
+  if (n >= mLength) {
+    CQUEUE_THROW(std::out_of_range("mmqueue access out-of-range"));
+  }
+  return getSlots()[getIndex(n)];
+}
+
+/**
+ * @details Slots popped since the last sync are reused only after syncing
+ *          (they are still part of the synced state).
+ * @param[in] val Value to add.
+ * @return true = inserted, false = queue full.
+ * @exception std::system_error msync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+bool gto::mmqueue<T>::try_push(const T &val) {
+  if (mLength == mReserved) {
+    return false;
+  }
+  if (getHeader().length + mPushed >= mReserved) {
+    sync();
+  }
+  std::memcpy(static_cast<void *>(getSlots() + getIndex(mLength)), &val, sizeof(T));
+  ++mLength;
+  ++mPushed;
+  onModified();
+  return true;
+}
+
+/**
+ * @param[in] val Value to add.
+ * @exception std::length_error Queue is full.
+ * @exception std::system_error msync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::mmqueue<T>::push(const T &val) {
+  if (!try_push(val)) {
+    CQUEUE_THROW(std::length_error("mmqueue capacity exceeded"));
+  }
+}
+
+/**
+ * @return Removed element, or nullopt if there are no elements in the queue.
+ * @exception std::system_error msync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::mmqueue<T>::try_pop() -> std::optional<T> {
+  if (mLength == 0) {
+    return std::nullopt;
+  }
+  return pop();
+}
+
+/**
+ * @return Removed element.
+ * @exception std::out_of_range Queue is empty.
+ * @exception std::system_error msync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+T gto::mmqueue<T>::pop() {
+  T ret = front();
+  mFront = getIndex(1);
+  --mLength;
+  onModified();
+  return ret;
+}
@@ -0,0 +1,75 @@
+#include "monotonic.hpp"
+
+#include <set>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+#define DEFAULT_NUM_ITEMS 10000000
+#define WINDOW_SIZE 10000
+#define BATCH_SIZE 64
+
+// g++ -std=c++20 -O3 -o monotonic-prof monotonic-prof.cpp
+// ./monotonic-prof [num-items]
+// Sliding window maximum over random values (push, evict, query per item)
+// using monotonic_cqueue (single and bulk push) and std::multiset.
+
+using namespace gto;
+
+template<typename Fn>
+void measure(const char *name, std::size_t n, Fn fn) {
+  auto t1 = std::chrono::steady_clock::now();
+  std::int64_t checksum = fn();
+  auto t2 = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+  std::cout
+      << name << " elapsed time in microseconds : " << us << " µs ("
+      << (n > 0 ? static_cast<double>(us) * 1000.0 / static_cast<double>(n) : 0.0) << " ns/item, "
+      << "checksum " << checksum << ")\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t n = (argc > 1 ? std::stoul(argv[1]) : DEFAULT_NUM_ITEMS);
+  std::vector<std::int64_t> values(n);
+  std::mt19937_64 rng(1);
+  for (auto &val : values) {
+    val = static_cast<std::int64_t>(rng() % 1000000);
+  }
+
+  measure("monotonic_cqueue", n, [&]() {
+    monotonic_cqueue<std::int64_t> queue;
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      queue.push(values[i]);
+      if (queue.size() > WINDOW_SIZE) queue.pop();
+      sum += queue.top();
+    }
+    return sum;
+  });
+
+  measure("monotonic_cqueue (bulk)", n, [&]() {
+    monotonic_cqueue<std::int64_t> queue;
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < n; i += BATCH_SIZE) {
+      auto last = values.begin() + static_cast<std::ptrdiff_t>(std::min(n, i + BATCH_SIZE));
+      queue.push_bulk(values.begin() + static_cast<std::ptrdiff_t>(i), last);
+      if (queue.size() > WINDOW_SIZE) queue.pop_until_seq(queue.next_seq() - WINDOW_SIZE);
+      sum += queue.top();
+    }
+    return sum;
+  });
+
+  measure("std::multiset", n, [&]() {
+    std::multiset<std::int64_t> window;
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      window.insert(values[i]);
+      if (window.size() > WINDOW_SIZE) window.erase(window.find(values[i - WINDOW_SIZE]));
+      sum += *window.rbegin();
+    }
+    return sum;
+  });
+}
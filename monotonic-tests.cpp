@@ -0,0 +1,106 @@
+#include <deque>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include "catch.hpp"
+#include "monotonic.hpp"
+
+using gto::monotonic_cqueue;
+
+TEST_CASE("monotonic_cqueue") {
+
+  SECTION("max") {
+    monotonic_cqueue<int> queue;
+    CHECK(queue.empty());
+    CHECK_THROWS_AS(queue.top(), std::out_of_range);
+    CHECK_THROWS_AS(queue.pop(), std::out_of_range);
+    CHECK(queue.push(3) == 0);
+    CHECK(queue.push(1) == 1);
+    CHECK(queue.push(2) == 2);
+    CHECK(queue.size() == 3);
+    CHECK(queue.retained() == 2);
+    CHECK(queue.top() == 3);
+    CHECK(queue.top_seq() == 0);
+    queue.pop();
+    CHECK(queue.top() == 2);
+    CHECK(queue.size() == 2);
+    queue.push(2);
+    CHECK(queue.retained() == 1);
+    CHECK(queue.top_seq() == 3);
+    queue.pop();
+    CHECK(queue.top() == 2);
+    CHECK(queue.pop_until_seq(4) == 2);
+    CHECK(queue.empty());
+    CHECK(queue.retained() == 0);
+    CHECK(queue.next_seq() == 4);
+  }
+
+  SECTION("min") {
+    monotonic_cqueue<int, std::greater<int>> queue;
+    for (int val : {5, 3, 8, 4}) queue.push(val);
+    CHECK(queue.top() == 3);
+    CHECK(queue.pop_until_seq(2) == 2);
+    CHECK(queue.top() == 4);
+    CHECK(queue.pop_until_seq(100) == 2);
+    CHECK(queue.empty());
+    CHECK(queue.pop_until_seq(0) == 0);
+    queue.push(1);
+    queue.clear();
+    CHECK(queue.empty());
+    CHECK(queue.base_seq() == 5);
+  }
+
+  SECTION("bulk") {
+    monotonic_cqueue<int> queue;
+    for (int val : {9, 7, 5, 3, 1}) queue.push(val);
+    std::vector<int> batch{2, 6, 4, 6, 1};
+    CHECK(queue.push_bulk(batch.begin(), batch.end()) == 5);
+    CHECK(queue.size() == 10);
+    // 9, 7, 6 (seq 8), 1
+    CHECK(queue.retained() == 4);
+    CHECK(queue.top() == 9);
+    CHECK(queue.pop_until_seq(2) == 2);
+    CHECK(queue.top() == 6);
+    CHECK(queue.top_seq() == 8);
+    CHECK(queue.push_bulk(batch.begin(), batch.begin()) == 0);
+    CHECK(queue.pop_until_seq(9) == 7);
+    CHECK(queue.top() == 1);
+  }
+
+  SECTION("random windows") {
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> dist(0, 1000);
+    monotonic_cqueue<int> qmax;
+    monotonic_cqueue<int, std::greater<int>> qmin;
+    std::deque<int> window;
+    for (int i = 0; i < 5000; i++) {
+      if (rng() % 4 == 0) {
+        std::vector<int> batch(rng() % 20);
+        for (int &val : batch) val = dist(rng);
+        qmax.push_bulk(batch.begin(), batch.end());
+        qmin.push_bulk(batch.begin(), batch.end());
+        window.insert(window.end(), batch.begin(), batch.end());
+      }
+      else {
+        int val = dist(rng);
+        qmax.push(val);
+        qmin.push(val);
+        window.push_back(val);
+      }
+      while (window.size() > 50) {
+        window.pop_front();
+        qmax.pop();
+        qmin.pop();
+      }
+      REQUIRE(qmax.size() == window.size());
+      if (!window.empty()) {
+        REQUIRE(qmax.top() == *std::max_element(window.begin(), window.end()));
+        REQUIRE(qmin.top() == *std::min_element(window.begin(), window.end()));
+      }
+    }
+  }
+
+}
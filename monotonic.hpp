@@ -0,0 +1,234 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Monotonic queue giving the extremum of a sliding window.
+ *
+ * @details Window items are pushed at the back and evicted from the front
+ *          (FIFO), each one identified by its sequence number. Only items
+ *          that can become the extremum are retained: pushing an item
+ *          removes the retained items it dominates (those not preceding it
+ *          by compare), so retained items are strictly ordered and the
+ *          extremum is the front one. push, evict and top are amortized O(1).
+ *          With Compare = std::less the extremum is the maximum (like
+ *          std::priority_queue); use std::greater for the minimum.
+ *          push_bulk() finds the batch extremum, removes all the retained
+ *          items it dominates at once (binary search over the contiguous
+ *          segments of the ring), and discards the batch items before it.
+ *
+ * @note This class is not thread-safe (like cqueue).
+ *
+ * @tparam T Elements type.
+ * @tparam Compare Strict weak ordering (extremum is the greatest item).
+ * @tparam Allocator Allocator.
+ */
+template<std::movable T, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class monotonic_cqueue
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using seq_type = std::uint64_t;
+    using const_reference = const value_type &;
+
+  private: // declarations
+
+    //! Retained item.
+    struct entry {
+      //! Sequence number.
+      seq_type seq;
+      //! Item value.
+      T value;
+    };
+
+    using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry>;
+
+  private: // members
+
+    //! Retained items (strictly decreasing by compare).
+    cqueue<entry, entry_allocator> mQueue;
+    //! Comparison function.
+    Compare mCompare{};
+    //! Sequence number of the oldest window item.
+    seq_type mBase = 0;
+    //! Sequence number of the next pushed item.
+    seq_type mNext = 0;
+
+  private: // methods
+
+    //! Push an item removing dominated ones.
+    template<typename U>
+    void pushEntry(seq_type seq, U &&val);
+    //! Number of retained items not dominated by val (binary search).
+    size_type getUndominated(const T &val) const;
+
+  public: // methods
+
+    //! Constructor.
+    explicit monotonic_cqueue(const Compare &comp = Compare(), const Allocator &alloc = Allocator()) :
+      mQueue(0, entry_allocator(alloc)), mCompare(comp) {}
+
+    //! Number of items in the window.
+    size_type size() const noexcept { return static_cast<size_type>(mNext - mBase); }
+    //! Check if window is empty.
+    [[nodiscard]] bool empty() const noexcept { return mNext == mBase; }
+    //! Number of retained items.
+    size_type retained() const noexcept { return mQueue.size(); }
+    //! Sequence number of the oldest window item.
+    seq_type base_seq() const noexcept { return mBase; }
+    //! Sequence number of the next pushed item.
+    seq_type next_seq() const noexcept { return mNext; }
+
+    //! Return the window extremum.
+    const_reference top() const;
+    //! Sequence number of the window extremum.
+    seq_type top_seq() const;
+
+    //! Insert an item (returns its sequence number).
+    seq_type push(const T &val) { pushEntry(mNext, val); return mNext++; }
+    //! Insert an item (returns its sequence number).
+    seq_type push(T &&val) { pushEntry(mNext, std::move(val)); return mNext++; }
+    //! Insert a batch of items (returns number of items).
+    template<std::forward_iterator It>
+    size_type push_bulk(It first, It last);
+    //! Evict the oldest window item.
+    void pop();
+    //! Evict window items whose sequence number precedes seq (returns number of evicted items).
+    size_type pop_until_seq(seq_type seq);
+    //! Remove all items.
+    void clear() noexcept { mQueue.clear(); mBase = mNext; }
+};
+
+} // namespace gto
+
+/**
+ * @param[in] seq Item sequence number.
+ * @param[in] val Item value.
+ */
+template<std::movable T, typename Compare, typename Allocator>
+template<typename U>
+void gto::monotonic_cqueue<T, Compare, Allocator>::pushEntry(seq_type seq, U &&val) {
+  while (!mQueue.empty() && !mCompare(val, mQueue.back().value)) {
+    mQueue.pop_back();
+  }
+  mQueue.push_back(entry{seq, std::forward<U>(val)});
+}
+
+/**
+ * @details Retained items are strictly decreasing, so the items dominated
+ *          by val are a suffix, found by binary search on the (at most
+ *          two) contiguous segments.
+ * @param[in] val Value.
+ * @return Length of the prefix of retained items not dominated by val.
+ */
+template<std::movable T, typename Compare, typename Allocator>
+auto gto::monotonic_cqueue<T, Compare, Allocator>::getUndominated(const T &val) const -> size_type {
+  auto pred = [this, &val](const entry &e) { return mCompare(val, e.value); };
+  auto [seg1, seg2] = mQueue.spans();
+  auto it1 = std::partition_point(seg1.begin(), seg1.end(), pred);
+  if (it1 != seg1.end()) {
+    return static_cast<size_type>(it1 - seg1.begin());
+  }
+  auto it2 = std::partition_point(seg2.begin(), seg2.end(), pred);
+  return seg1.size() + static_cast<size_type>(it2 - seg2.begin());
+}
+
+/**
+ * @return The greatest window item (by compare).
+ * @exception std::out_of_range Empty window.
+ */
+template<std::movable T, typename Compare, typename Allocator>
+auto gto::monotonic_cqueue<T, Compare, Allocator>::top() const -> const_reference {
+  return mQueue.front().value;
+}
+
+/**
+ * @return Sequence number of the greatest window item (the latest one on ties).
+ * @exception std::out_of_range Empty window.
+ */
+template<std::movable T, typename Compare, typename Allocator>
+auto gto::monotonic_cqueue<T, Compare, Allocator>::top_seq() const -> seq_type {
+  return mQueue.front().seq;
+}
+
+/**
+ * @details Items before the batch extremum are dominated by it and are not
+ *          retained. Retained items dominated by the batch extremum are
+ *          removed in a single erase.
+ * @param[in] first First item of the batch.
+ * @param[in] last Past the last item of the batch.
+ * @return Number of pushed items (sequence numbers from the previous next_seq).
+ */
+template<std::movable T, typename Compare, typename Allocator>
+template<std::forward_iterator It>
+auto gto::monotonic_cqueue<T, Compare, Allocator>::push_bulk(It first, It last) -> size_type {
+  if (first == last) {
+    return 0;
+  }
+
+  // batch extremum (latest one on ties)
+  It best = first;
+  size_type pos = 0;
+  size_type n = 0;
+  for (It it = first; it != last; ++it, ++n) {
+    if (!mCompare(*it, *best)) {
+      best = it;
+      pos = n;
+    }
+  }
+
+  size_type len = getUndominated(*best);
+  mQueue.erase(mQueue.begin() + static_cast<std::ptrdiff_t>(len), mQueue.end());
+  mQueue.push_back(entry{mNext + pos, *best});
+
+  seq_type seq = mNext + pos + 1;
+  for (It it = std::next(best); it != last; ++it, ++seq) {
+    pushEntry(seq, *it);
+  }
+
+  mNext += n;
+  return n;
+}
+
+/**
+ * @exception std::out_of_range Empty window.
+ */
+template<std::movable T, typename Compare, typename Allocator>
+void gto::monotonic_cqueue<T, Compare, Allocator>::pop() {
+  if (empty()) {
+    CQUEUE_THROW(std::out_of_range("monotonic_cqueue empty"));
+  }
+  if (mQueue.front().seq == mBase) {
+    mQueue.pop_front();
+  }
+  mBase++;
+}
+
+/**
+ * @details Sequence numbers before base_seq() evict nothing, and those
+ *          after next_seq() evict all items.
+ * @param[in] seq First sequence number to keep.
+ * @return Number of evicted window items.
+ */
+template<std::movable T, typename Compare, typename Allocator>
+auto gto::monotonic_cqueue<T, Compare, Allocator>::pop_until_seq(seq_type seq) -> size_type {
+  seq = std::clamp(seq, mBase, mNext);
+  while (!mQueue.empty() && mQueue.front().seq < seq) {
+    mQueue.pop_front();
+  }
+  auto ret = static_cast<size_type>(seq - mBase);
+  mBase = seq;
+  return ret;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <utility>
+#include <system_error>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Notifier policy that notifies nothing (default).
+ */
+struct nonotifier {
+  //! Called when the queue becomes non-empty.
+  constexpr void notify() noexcept {}
+};
+
+/**
+ * @brief Notifier policy signaling an eventfd.
+ *
+ * @details The eventfd is non-blocking and becomes readable when notified,
+ *          so it can be registered in an epoll (or poll/select) set along
+ *          with sockets and timers. Consumers call reset() before draining
+ *          the queue.
+ *
+ * @see https://man7.org/linux/man-pages/man2/eventfd.2.html
+ */
+class eventfd_notifier
+{
+  private: // members
+
+    //! Event file descriptor.
+    int mFd = -1;
+
+  public: // methods
+
+    //! Constructor (creates the eventfd).
+    eventfd_notifier();
+    //! Move constructor.
+    eventfd_notifier(eventfd_notifier &&other) noexcept { std::swap(mFd, other.mFd); }
+    //! Move assignment.
+    eventfd_notifier & operator=(eventfd_notifier &&other) noexcept { std::swap(mFd, other.mFd); return *this; }
+    //! Non-copyable.
+    eventfd_notifier(const eventfd_notifier &) = delete;
+    //! Non-copyable.
+    eventfd_notifier & operator=(const eventfd_notifier &) = delete;
+    //! Destructor (closes the eventfd).
+    ~eventfd_notifier() { if (mFd >= 0) ::close(mFd); }
+
+    //! File descriptor to register in epoll (EPOLLIN).
+    int fd() const noexcept { return mFd; }
+    //! Make the eventfd readable.
+    void notify() noexcept;
+    //! Clear the eventfd (returns the number of pending notifications).
+    std::uint64_t reset() noexcept;
+};
+
+} // namespace gto
+
+/**
+ * @exception std::system_error eventfd can not be created.
+ */
+inline gto::eventfd_notifier::eventfd_notifier() :
+  mFd{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
+{
+  if (mFd < 0) {
+    CQUEUE_THROW(std::system_error(errno, std::generic_category(), "eventfd"));
+  }
+}
+
+/**
+ * @details Write errors are ignored (counter overflow is not possible
+ *          while notifications are coalesced).
+ */
+inline void gto::eventfd_notifier::notify() noexcept {
+  std::uint64_t val = 1;
+  [[maybe_unused]] auto rc = ::write(mFd, &val, sizeof(val));
+}
+
+/**
+ * @return Number of notifications since the last reset (0 = none).
+ */
+inline std::uint64_t gto::eventfd_notifier::reset() noexcept {
+  std::uint64_t val = 0;
+  if (::read(mFd, &val, sizeof(val)) != sizeof(val)) {
+    return 0;
+  }
+  return val;
+}
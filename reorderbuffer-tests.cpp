@@ -0,0 +1,147 @@
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include "catch.hpp"
+#include "reorderbuffer.hpp"
+
+using gto::reorder_buffer;
+
+TEST_CASE("reorder_buffer") {
+
+  SECTION("basic") {
+    reorder_buffer<std::string> rob(10, 16);
+    std::vector<std::string> out;
+    CHECK(rob.empty());
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 0);
+    CHECK(rob.insert_at_seq(12, "c"));
+    CHECK(rob.insert_at_seq(11, "b"));
+    CHECK(!rob.insert_at_seq(11, "x"));
+    CHECK(rob.size() == 2);
+    CHECK(rob.window() == 3);
+    CHECK(rob.missing() == 1);
+    CHECK(rob.ready() == 0);
+    CHECK(rob.contains_seq(11));
+    CHECK(!rob.contains_seq(10));
+    CHECK(!rob.contains_seq(13));
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 0);
+    CHECK(rob.emplace_at_seq(10, std::size_t{1}, 'a'));
+    CHECK(rob.ready() == 3);
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 3);
+    CHECK(out == std::vector<std::string>{"a", "b", "c"});
+    CHECK(rob.empty());
+    CHECK(rob.base_seq() == 13);
+    // already released
+    CHECK(!rob.insert_at_seq(12, "c"));
+    CHECK(!rob.contains_seq(12));
+  }
+
+  SECTION("word boundaries") {
+    reorder_buffer<int> rob(60, 256);
+    std::vector<int> out;
+    // seqs 60..259 with a gap at 200
+    for (int i = 259; i >= 60; i--) {
+      if (i != 200) {
+        CHECK(rob.insert_at_seq(static_cast<std::uint64_t>(i), i));
+      }
+    }
+    CHECK(rob.ready() == 140);
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 140);
+    CHECK(rob.base_seq() == 200);
+    CHECK(rob.size() == 59);
+    CHECK(rob.insert_at_seq(200, 200));
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 60);
+    CHECK(out.size() == 200);
+    for (int i = 0; i < 200; i++) {
+      REQUIRE(out[static_cast<std::size_t>(i)] == i + 60);
+    }
+  }
+
+  SECTION("skip lost items") {
+    reorder_buffer<int> rob(0, 256);
+    std::vector<int> out;
+    for (int i = 0; i < 150; i++) {
+      if (i % 3 != 0) rob.insert_at_seq(static_cast<std::uint64_t>(i), i);
+    }
+    CHECK(rob.size() == 100);
+    CHECK(rob.skip_to_seq(0) == 0);
+    // drops 1,2 and 70 items in [3,108)
+    CHECK(rob.skip_to_seq(108) == 72);
+    CHECK(rob.base_seq() == 108);
+    CHECK(rob.size() == 28);
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 0);
+    CHECK(rob.skip_to_seq(109) == 0);
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 2);
+    CHECK(out == std::vector<int>{109, 110});
+    // beyond window
+    CHECK(rob.skip_to_seq(1000) == 26);
+    CHECK(rob.empty());
+    CHECK(rob.window() == 0);
+    CHECK(rob.insert_at_seq(1000, 1));
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 1);
+  }
+
+  SECTION("capacity") {
+    reorder_buffer<int> rob(0, 8);
+    CHECK(rob.capacity() == 8);
+    CHECK(rob.insert_at_seq(7, 7));
+    CHECK(rob.window() == 8);
+    CHECK(rob.missing() == 7);
+    CHECK_THROWS_AS(rob.insert_at_seq(8, 8), std::length_error);
+    // far-ahead sequence rejected without allocating
+    CHECK_THROWS_AS(rob.insert_at_seq(std::uint64_t{1} << 40, 0), std::length_error);
+    CHECK(rob.window() == 8);
+    CHECK_THROWS_AS(reorder_buffer<int>(0, 0), std::length_error);
+    // window slides with base
+    CHECK(rob.skip_to_seq(4) == 0);
+    CHECK(rob.insert_at_seq(11, 11));
+    CHECK(rob.window() == 8);
+    CHECK(rob.missing() == 6);
+    rob.reset(5);
+    CHECK(rob.empty());
+    CHECK(rob.base_seq() == 5);
+    CHECK(!rob.insert_at_seq(4, 4));
+  }
+
+  SECTION("wrap") {
+    constexpr std::uint64_t MAX = std::numeric_limits<std::uint64_t>::max();
+    reorder_buffer<int> rob(MAX - 1, 8);
+    std::vector<int> out;
+    CHECK(rob.insert_at_seq(1, 3));
+    CHECK(rob.insert_at_seq(MAX, 1));
+    CHECK(rob.insert_at_seq(MAX - 1, 0));
+    CHECK(!rob.insert_at_seq(MAX - 2, -1));
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 2);
+    CHECK(rob.base_seq() == 0);
+    CHECK(rob.insert_at_seq(0, 2));
+    CHECK(rob.pop_ready(std::back_inserter(out)) == 2);
+    CHECK(out == std::vector<int>{0, 1, 2, 3});
+  }
+
+  SECTION("random") {
+    constexpr std::uint64_t NUM_ITEMS = 20000;
+    std::vector<std::uint64_t> seqs(NUM_ITEMS);
+    for (std::uint64_t i = 0; i < NUM_ITEMS; i++) seqs[i] = i;
+    // overlapping local shuffles
+    std::mt19937 rng(7);
+    for (std::size_t i = 0; i + 100 <= seqs.size(); i += 50) {
+      std::shuffle(seqs.begin() + static_cast<std::ptrdiff_t>(i), seqs.begin() + static_cast<std::ptrdiff_t>(i + 100), rng);
+    }
+    reorder_buffer<std::uint64_t> rob(0, 1024);
+    std::vector<std::uint64_t> out;
+    for (std::uint64_t seq : seqs) {
+      REQUIRE(rob.insert_at_seq(seq, seq));
+      rob.pop_ready(std::back_inserter(out));
+    }
+    CHECK(rob.empty());
+    REQUIRE(out.size() == NUM_ITEMS);
+    for (std::uint64_t i = 0; i < NUM_ITEMS; i++) {
+      REQUIRE(out[i] == i);
+    }
+  }
+
+}
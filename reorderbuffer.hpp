@@ -0,0 +1,316 @@
+#pragma once
+
+#include <bit>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <concepts>
+#include <algorithm>
+#include <stdexcept>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Reorder buffer releasing in-sequence runs of out-of-order items.
+ *
+ * @details Items are inserted by sequence number (insert_at_seq) in any
+ *          order, and released in sequence order (pop_ready) once there
+ *          are no gaps before them.
+ *          Slots are stored in a cqueue covering [base_seq, last inserted],
+ *          and presence is tracked by a bitmap (one bit per slot, in a
+ *          cqueue of 64-bits words aligned with the slots ring). The ready
+ *          prefix is found with bit-scan instructions (std::countr_one), 64
+ *          slots per step, instead of checking every slot.
+ *          Missing slots hold a default-constructed item, so the window is
+ *          bounded (max_window): a far-ahead sequence number is rejected
+ *          instead of allocating all the slots before it. Sequence numbers
+ *          are compared using serial number arithmetic (wrap-safe).
+ *
+ * @note This class is not thread-safe (like cqueue).
+ *
+ * @tparam T Elements type.
+ * @tparam Allocator Allocator.
+ */
+template<std::movable T, typename Allocator = std::allocator<T>>
+  requires std::default_initializable<T>
+class reorder_buffer
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using seq_type = std::uint64_t;
+
+  private: // declarations
+
+    using word_type = std::uint64_t;
+    using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<word_type>;
+
+    //! Bits per bitmap word.
+    static constexpr size_type WORD_BITS = 64;
+
+  private: // members
+
+    //! Slots (front slot has sequence number mBase).
+    cqueue<T, Allocator> mSlots;
+    //! Presence bitmap (slot i is bit mShift + i).
+    cqueue<word_type, word_allocator> mBits{};
+    //! Bit of the first slot in the first word.
+    size_type mShift = 0;
+    //! Sequence number of the first slot.
+    seq_type mBase = 0;
+    //! Number of present items.
+    size_type mCount = 0;
+    //! Max window length.
+    size_type mMaxWindow = 0;
+
+  private: // methods
+
+    //! Distance from base (wraps).
+    seq_type getOffset(seq_type seq) const noexcept { return seq - mBase; }
+    //! Check slot presence.
+    bool isPresent(size_type offset) const;
+    //! Length of the present slots prefix.
+    size_type getReady() const;
+    //! Remove the first n slots from bitmap.
+    void advance(size_type n);
+
+  public: // methods
+
+    //! Constructor (slots allocated on demand up to max_window).
+    reorder_buffer(seq_type base, size_type max_window, const Allocator &alloc = Allocator());
+
+    //! Max window length.
+    size_type capacity() const noexcept { return mMaxWindow; }
+    //! Number of buffered items.
+    size_type size() const noexcept { return mCount; }
+    //! Check if there are buffered items.
+    [[nodiscard]] bool empty() const noexcept { return mCount == 0; }
+    //! Number of slots from base_seq to the last buffered item.
+    size_type window() const noexcept { return mSlots.size(); }
+    //! Number of missing items in window.
+    size_type missing() const noexcept { return mSlots.size() - mCount; }
+    //! Sequence number of the next item to release.
+    seq_type base_seq() const noexcept { return mBase; }
+    //! Number of items ready to be released.
+    size_type ready() const { return getReady(); }
+    //! Check if the item with the given sequence number is buffered.
+    bool contains_seq(seq_type seq) const;
+
+    //! Insert an item (false if already released or duplicated).
+    bool insert_at_seq(seq_type seq, const T &val) { return emplace_at_seq(seq, val); }
+    //! Insert an item (false if already released or duplicated).
+    bool insert_at_seq(seq_type seq, T &&val) { return emplace_at_seq(seq, std::move(val)); }
+    //! Construct and insert an item (false if already released or duplicated).
+    template <class... Args>
+    bool emplace_at_seq(seq_type seq, Args&&... args);
+    //! Release the ready prefix to out (returns number of released items).
+    template<typename OutputIt>
+    size_type pop_ready(OutputIt out);
+    //! Give up items before seq, present or missing (returns number of dropped items).
+    size_type skip_to_seq(seq_type seq);
+    //! Remove all items and set the base sequence number.
+    void reset(seq_type base) noexcept;
+};
+
+} // namespace gto
+
+/**
+ * @param[in] base Sequence number of the first item.
+ * @param[in] max_window Max distance from base of an inserted item (plus one).
+ * @param[in] alloc Allocator to use.
+ * @exception std::length_error Invalid max window.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+gto::reorder_buffer<T, Allocator>::reorder_buffer(seq_type base, size_type max_window, const Allocator &alloc) :
+  mSlots(max_window, alloc), mBits(0, word_allocator(alloc)), mBase(base), mMaxWindow(max_window)
+{
+  if (max_window == 0) {
+    CQUEUE_THROW(std::length_error("reorder_buffer invalid max window"));
+  }
+}
+
+/**
+ * @param[in] offset Slot index (less than window).
+ * @return true = item present.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+bool gto::reorder_buffer<T, Allocator>::isPresent(size_type offset) const {
+  size_type bit = mShift + offset;
+  return (mBits[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1u;
+}
+
+/**
+ * @return Number of consecutive present slots from base.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::reorder_buffer<T, Allocator>::getReady() const -> size_type {
+  size_type ret = 0;
+  size_type bit = mShift;
+  auto [seg1, seg2] = mBits.spans();
+  for (const auto &seg : {seg1, seg2}) {
+    for (word_type word : seg) {
+      auto ones = static_cast<size_type>(std::countr_one(word >> bit));
+      ret += ones;
+      if (ones < WORD_BITS - bit) {
+        return std::min(ret, mSlots.size());
+      }
+      bit = 0;
+    }
+  }
+  return std::min(ret, mSlots.size());
+}
+
+/**
+ * @param[in] n Number of slots removed from the front.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+void gto::reorder_buffer<T, Allocator>::advance(size_type n) {
+  mBase += n;
+  size_type bits = mShift + n;
+  mBits.consume_front(bits / WORD_BITS, [](word_type &) {});
+  mShift = bits % WORD_BITS;
+  if (mBits.empty()) {
+    mShift = 0;
+  }
+  else {
+    // clear released bits (mBits[0] is reused by next slots)
+    mBits.front() &= ~((word_type{1} << mShift) - 1);
+  }
+}
+
+/**
+ * @param[in] seq Sequence number.
+ * @return true = item buffered (not released and not missing).
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+bool gto::reorder_buffer<T, Allocator>::contains_seq(seq_type seq) const {
+  seq_type offset = getOffset(seq);
+  return (offset < mSlots.size() && isPresent(static_cast<size_type>(offset)));
+}
+
+/**
+ * @details Missing slots up to seq are added in a single step.
+ * @param[in] seq Sequence number of the item.
+ * @param[in] args Arguments of the new item.
+ * @return true = inserted, false = already released (before base) or
+ *         already buffered.
+ * @exception std::length_error Sequence number exceeds max window.
+ * @exception ... Error throwed by constructors.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+template <class... Args>
+bool gto::reorder_buffer<T, Allocator>::emplace_at_seq(seq_type seq, Args&&... args) {
+  seq_type offset = getOffset(seq);
+  if (static_cast<std::int64_t>(offset) < 0) {
+    return false;
+  }
+  if (offset < mSlots.size() && isPresent(static_cast<size_type>(offset))) {
+    return false;
+  }
+  if (offset >= mMaxWindow) {
+    CQUEUE_THROW(std::length_error("reorder_buffer sequence exceeds max window"));
+  }
+
+  auto pos = static_cast<size_type>(offset);
+  size_type bit = mShift + pos;
+  if (mBits.size() <= bit / WORD_BITS) {
+    mBits.insert(mBits.end(), bit / WORD_BITS + 1 - mBits.size(), word_type{0});
+  }
+  if (mSlots.size() <= pos) {
+    auto [seg1, seg2] = mSlots.prepare_back(pos + 1 - mSlots.size());
+    std::uninitialized_value_construct(seg1.begin(), seg1.end());
+    mSlots.commit_back(seg1.size());
+    std::uninitialized_value_construct(seg2.begin(), seg2.end());
+    mSlots.commit_back(seg2.size());
+  }
+
+  mSlots[pos] = T(std::forward<Args>(args)...);
+  mBits[bit / WORD_BITS] |= word_type{1} << (bit % WORD_BITS);
+  ++mCount;
+  return true;
+}
+
+/**
+ * @details Ready items are moved to out in sequence order in a single pass.
+ * @param[in] out Output iterator.
+ * @return Number of released items.
+ * @exception ... Error throwed by out (released items are removed).
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+template<typename OutputIt>
+auto gto::reorder_buffer<T, Allocator>::pop_ready(OutputIt out) -> size_type {
+  size_type n = getReady();
+  if (n == 0) {
+    return 0;
+  }
+  size_type done = 0;
+  CQUEUE_TRY {
+    mSlots.consume_front(n, [&out, &done](T &item) {
+      *out++ = std::move(item);
+      ++done;
+    });
+  } CQUEUE_CATCH_ALL {
+    mCount -= done;
+    advance(done);
+    CQUEUE_RETHROW;
+  }
+  mCount -= n;
+  advance(n);
+  return n;
+}
+
+/**
+ * @details Used when missing items are considered lost. Items with
+ *          sequence number before seq are destroyed.
+ * @param[in] seq New base sequence number (ignored if before base).
+ * @return Number of dropped (present) items.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+auto gto::reorder_buffer<T, Allocator>::skip_to_seq(seq_type seq) -> size_type {
+  seq_type offset = getOffset(seq);
+  if (static_cast<std::int64_t>(offset) <= 0) {
+    return 0;
+  }
+  if (offset >= mSlots.size()) {
+    size_type ret = mCount;
+    reset(seq);
+    return ret;
+  }
+
+  auto n = static_cast<size_type>(offset);
+  size_type ret = 0;
+  for (size_type bit = mShift; bit < mShift + n; bit = (bit / WORD_BITS + 1) * WORD_BITS) {
+    size_type len = std::min(WORD_BITS - bit % WORD_BITS, mShift + n - bit);
+    word_type word = mBits[bit / WORD_BITS] >> (bit % WORD_BITS);
+    word_type mask = (len == WORD_BITS ? ~word_type{0} : (word_type{1} << len) - 1);
+    ret += static_cast<size_type>(std::popcount(word & mask));
+  }
+  mSlots.consume_front(n, [](T &) {});
+  mCount -= ret;
+  advance(n);
+  return ret;
+}
+
+/**
+ * @param[in] base New base sequence number.
+ */
+template<std::movable T, typename Allocator>
+  requires std::default_initializable<T>
+void gto::reorder_buffer<T, Allocator>::reset(seq_type base) noexcept {
+  mSlots.clear();
+  mBits.clear();
+  mShift = 0;
+  mBase = base;
+  mCount = 0;
+}
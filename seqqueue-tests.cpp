@@ -0,0 +1,105 @@
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include "catch.hpp"
+#include "seqqueue.hpp"
+
+using gto::seqqueue;
+
+TEST_CASE("seqqueue") {
+
+  SECTION("basic") {
+    seqqueue<std::string> queue(100);
+    CHECK(queue.empty());
+    CHECK(queue.base_seq() == 100);
+    CHECK(queue.next_seq() == 100);
+    CHECK(!queue.contains_seq(100));
+    CHECK_THROWS_AS(queue.at_seq(100), std::out_of_range);
+    CHECK(queue.push("a") == 100);
+    CHECK(queue.push("b") == 101);
+    CHECK(queue.emplace(1, 'c') == 102);
+    CHECK(queue.size() == 3);
+    CHECK(queue.next_seq() == 103);
+    CHECK(queue.contains_seq(101));
+    CHECK(!queue.contains_seq(99));
+    CHECK(!queue.contains_seq(103));
+    CHECK(queue.at_seq(102) == "c");
+    queue.at_seq(101) = "B";
+    const auto &cref = queue;
+    CHECK(cref.at_seq(101) == "B");
+    CHECK(queue.front() == "a");
+    CHECK(queue.back() == "c");
+    CHECK(queue.pop() == "a");
+    CHECK(queue.base_seq() == 101);
+    CHECK(!queue.contains_seq(100));
+    CHECK(queue.at_seq(101) == "B");
+    queue.reset(7);
+    CHECK(queue.empty());
+    CHECK(queue.next_seq() == 7);
+    CHECK_THROWS_AS(queue.pop(), std::out_of_range);
+  }
+
+  SECTION("pop_until_seq") {
+    seqqueue<int> queue(10);
+    for (int i = 0; i < 10; i++) queue.push(i);
+    // already acked
+    CHECK(queue.pop_until_seq(5) == 0);
+    CHECK(queue.pop_until_seq(10) == 0);
+    std::vector<int> removed;
+    CHECK(queue.pop_until_seq(13, [&removed](int &val) { removed.push_back(val); }) == 3);
+    CHECK(removed == std::vector<int>{0, 1, 2});
+    CHECK(queue.base_seq() == 13);
+    CHECK(queue.front() == 3);
+    // ack beyond last sent
+    CHECK(queue.pop_until_seq(1000) == 7);
+    CHECK(queue.empty());
+    CHECK(queue.base_seq() == 20);
+  }
+
+  SECTION("callback throws") {
+    seqqueue<int> queue;
+    for (int i = 0; i < 5; i++) queue.push(i);
+    auto fn = [](const int &val) { if (val == 2) throw std::runtime_error("error"); };
+    CHECK_THROWS_AS(queue.pop_until_seq(5, fn), std::runtime_error);
+    CHECK(queue.base_seq() == 2);
+    CHECK(queue.front() == 2);
+    CHECK(queue.at_seq(4) == 4);
+  }
+
+  SECTION("wrap") {
+    constexpr std::uint64_t MAX = std::numeric_limits<std::uint64_t>::max();
+    seqqueue<int> queue(MAX - 2);
+    for (int i = 0; i < 6; i++) queue.push(i);
+    CHECK(queue.next_seq() == 3);
+    CHECK(queue.contains_seq(MAX - 2));
+    CHECK(queue.contains_seq(MAX));
+    CHECK(queue.contains_seq(0));
+    CHECK(queue.contains_seq(2));
+    CHECK(!queue.contains_seq(3));
+    CHECK(!queue.contains_seq(MAX - 3));
+    CHECK(queue.at_seq(MAX) == 2);
+    CHECK(queue.at_seq(0) == 3);
+    CHECK(queue.pop_until_seq(MAX - 5) == 0);
+    CHECK(queue.pop_until_seq(1) == 4);
+    CHECK(queue.base_seq() == 1);
+    CHECK(queue.at_seq(1) == 4);
+    CHECK(queue.push(6) == 3);
+  }
+
+  SECTION("capacity") {
+    seqqueue<int> queue(0, 2);
+    queue.push(1);
+    queue.push(2);
+    CHECK(queue.full());
+    CHECK_THROWS_AS(queue.push(3), std::length_error);
+    CHECK(queue.next_seq() == 2);
+    queue.pop_until_seq(1);
+    CHECK(queue.push(3) == 2);
+    int sum = 0;
+    for (int val : queue) sum += val;
+    CHECK(sum == 5);
+  }
+
+}
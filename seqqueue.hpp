@@ -0,0 +1,186 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Queue whose items are addressed by absolute sequence numbers.
+ *
+ * @details Every pushed item gets the next sequence number (base_seq() is
+ *          the sequence number of the front item). Items are accessed and
+ *          removed by sequence number instead of position, which is what
+ *          replay/retransmit windows need (unacked packets, last N messages).
+ *          Sequence numbers are 64-bits unsigned values compared using
+ *          serial number arithmetic (RFC 1982), so the queue keeps working
+ *          when the counter wraps.
+ *
+ * @note This class is not thread-safe (like cqueue).
+ *
+ * @tparam T Elements type.
+ * @tparam Allocator Allocator.
+ */
+template<std::movable T, typename Allocator = std::allocator<T>>
+class seqqueue
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using seq_type = std::uint64_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using const_iterator = typename cqueue<T, Allocator>::const_iterator;
+
+  private: // members
+
+    //! Retained items (front item has sequence number mBase).
+    cqueue<T, Allocator> mQueue;
+    //! Sequence number of the front item.
+    seq_type mBase = 0;
+
+  private: // methods
+
+    //! Distance from base (wraps).
+    seq_type getOffset(seq_type seq) const noexcept { return seq - mBase; }
+
+  public: // methods
+
+    //! Constructor (capacity=0 means unlimited).
+    explicit seqqueue(seq_type base = 0, size_type capacity = 0, const Allocator &alloc = Allocator()) :
+      mQueue(capacity, alloc), mBase(base) {}
+
+    //! Return queue capacity.
+    size_type capacity() const noexcept { return mQueue.capacity(); }
+    //! Return the number of items.
+    size_type size() const noexcept { return mQueue.size(); }
+    //! Check if there are items in the queue.
+    [[nodiscard]] bool empty() const noexcept { return mQueue.empty(); }
+    //! Check if queue is full.
+    bool full() const noexcept { return mQueue.full(); }
+    //! Sequence number of the front item.
+    seq_type base_seq() const noexcept { return mBase; }
+    //! Sequence number of the next pushed item.
+    seq_type next_seq() const noexcept { return mBase + mQueue.size(); }
+
+    //! Check if the item with the given sequence number is in the queue.
+    bool contains_seq(seq_type seq) const noexcept { return getOffset(seq) < mQueue.size(); }
+    //! Access item by sequence number.
+    reference at_seq(seq_type seq);
+    //! Access item by sequence number.
+    const_reference at_seq(seq_type seq) const;
+    //! Access the first item.
+    reference front() { return mQueue.front(); }
+    //! Access the first item.
+    const_reference front() const { return mQueue.front(); }
+    //! Access the last item.
+    reference back() { return mQueue.back(); }
+    //! Access the last item.
+    const_reference back() const { return mQueue.back(); }
+
+    //! Construct and insert an item (returns its sequence number).
+    template <class... Args>
+    seq_type emplace(Args&&... args);
+    //! Insert an item (returns its sequence number).
+    seq_type push(const T &val) { return emplace(val); }
+    //! Insert an item (returns its sequence number).
+    seq_type push(T &&val) { return emplace(std::move(val)); }
+    //! Remove the first item.
+    T pop();
+    //! Remove items whose sequence number precedes seq (returns number of removed items).
+    size_type pop_until_seq(seq_type seq) { return pop_until_seq(seq, [](T &) {}); }
+    //! Remove items whose sequence number precedes seq calling fn(item) for each one.
+    template<typename Fn>
+      requires std::invocable<Fn, T &>
+    size_type pop_until_seq(seq_type seq, Fn fn);
+    //! Remove all items and set the base sequence number.
+    void reset(seq_type base) noexcept { mQueue.clear(); mBase = base; }
+
+    //! Return an iterator to the first item.
+    const_iterator begin() const noexcept { return mQueue.begin(); }
+    //! Return an iterator past the last item.
+    const_iterator end() const noexcept { return mQueue.end(); }
+};
+
+} // namespace gto
+
+/**
+ * @param[in] seq Sequence number.
+ * @return Reference to the item.
+ * @exception std::out_of_range Item not in the queue.
+ */
+template<std::movable T, typename Allocator>
+auto gto::seqqueue<T, Allocator>::at_seq(seq_type seq) -> reference {
+  if (!contains_seq(seq)) {
+    CQUEUE_THROW(std::out_of_range("seqqueue sequence out of range"));
+  }
+  return mQueue[static_cast<size_type>(getOffset(seq))];
+}
+
+/**
+ * @param[in] seq Sequence number.
+ * @return Reference to the item.
+ * @exception std::out_of_range Item not in the queue.
+ */
+template<std::movable T, typename Allocator>
+auto gto::seqqueue<T, Allocator>::at_seq(seq_type seq) const -> const_reference {
+  if (!contains_seq(seq)) {
+    CQUEUE_THROW(std::out_of_range("seqqueue sequence out of range"));
+  }
+  return mQueue[static_cast<size_type>(getOffset(seq))];
+}
+
+/**
+ * @param[in] args Arguments of the new item.
+ * @return Sequence number of the inserted item.
+ * @exception std::length_error Number of values exceed queue capacity.
+ * @exception ... Error throwed by move/copy constructor.
+ */
+template<std::movable T, typename Allocator>
+template <class... Args>
+auto gto::seqqueue<T, Allocator>::emplace(Args&&... args) -> seq_type {
+  mQueue.emplace_back(std::forward<Args>(args)...);
+  return mBase + mQueue.size() - 1;
+}
+
+/**
+ * @return Removed item.
+ * @exception std::out_of_range No elements to pop.
+ */
+template<std::movable T, typename Allocator>
+T gto::seqqueue<T, Allocator>::pop() {
+  T ret = mQueue.pop_front();
+  mBase++;
+  return ret;
+}
+
+/**
+ * @details Sequence numbers before base_seq() (in serial number order)
+ *          remove nothing, and those after next_seq() remove all items.
+ *          Typical use is a cumulative ack: pop_until_seq(ack + 1).
+ * @param[in] seq First sequence number to keep.
+ * @param[in] fn Function called on each removed item (before destruction).
+ * @return Number of removed items.
+ * @exception ... Error throwed by fn (processed items are removed).
+ */
+template<std::movable T, typename Allocator>
+template<typename Fn>
+  requires std::invocable<Fn, T &>
+auto gto::seqqueue<T, Allocator>::pop_until_seq(seq_type seq, Fn fn) -> size_type {
+  seq_type offset = getOffset(seq);
+  if (static_cast<std::int64_t>(offset) <= 0) {
+    return 0;
+  }
+  auto n = static_cast<size_type>(std::min<seq_type>(offset, mQueue.size()));
+  // base advanced per item (consistent if fn throws)
+  return mQueue.consume_front(n, [this, &fn](T &item) {
+    fn(item);
+    ++mBase;
+  });
+}
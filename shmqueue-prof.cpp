@@ -0,0 +1,103 @@
+#include "shmqueue.hpp"
+
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <iostream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+
+#define NUM_MESSAGES 5'000'000
+#define CAPACITY 4096
+
+// g++ -std=c++20 -O3 -o shmqueue-prof shmqueue-prof.cpp
+// A child process sends NUM_MESSAGES to its parent through a shared memory
+// queue (spsc and mpmc modes) and through a socketpair (baseline).
+
+using namespace gto;
+
+//! Message exchanged between processes.
+struct message {
+  std::uint64_t id;
+  std::uint64_t payload[3];
+};
+
+template<shm_mode Mode>
+void run_shmqueue() {
+  auto queue = shmqueue<message, Mode>::create_anonymous(CAPACITY);
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    for (std::uint64_t i = 0; i < NUM_MESSAGES; i++) {
+      while (!queue.try_push(message{i, {i, i, i}})) {
+        std::this_thread::yield();
+      }
+    }
+    ::_exit(0);
+  }
+  message msg{};
+  for (std::uint64_t i = 0; i < NUM_MESSAGES; i++) {
+    while (!queue.try_pop(msg)) {
+      std::this_thread::yield();
+    }
+    if (msg.id != i) {
+      std::cerr << "error: unexpected message" << std::endl;
+    }
+  }
+  ::waitpid(pid, nullptr, 0);
+}
+
+void run_socketpair() {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    std::cerr << "error: socketpair" << std::endl;
+    return;
+  }
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::close(fds[0]);
+    for (std::uint64_t i = 0; i < NUM_MESSAGES; i++) {
+      message msg{i, {i, i, i}};
+      if (::write(fds[1], &msg, sizeof(msg)) != sizeof(msg)) {
+        ::_exit(1);
+      }
+    }
+    ::_exit(0);
+  }
+  ::close(fds[1]);
+  message msg{};
+  for (std::uint64_t i = 0; i < NUM_MESSAGES; i++) {
+    std::size_t len = 0;
+    while (len < sizeof(msg)) {
+      ssize_t rc = ::read(fds[0], reinterpret_cast<char *>(&msg) + len, sizeof(msg) - len);
+      if (rc <= 0) {
+        std::cerr << "error: read" << std::endl;
+        return;
+      }
+      len += static_cast<std::size_t>(rc);
+    }
+    if (msg.id != i) {
+      std::cerr << "error: unexpected message" << std::endl;
+    }
+  }
+  ::close(fds[0]);
+  ::waitpid(pid, nullptr, 0);
+}
+
+template<typename Fn>
+void measure(const char *name, Fn fn) {
+  auto t1 = std::chrono::steady_clock::now();
+  fn();
+  auto t2 = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+  std::cout
+      << name << " elapsed time in microseconds : " << us << " µs ("
+      << (us > 0 ? static_cast<std::uint64_t>(NUM_MESSAGES) * 1'000'000 / static_cast<std::uint64_t>(us) : 0)
+      << " msg/s)\n";
+}
+
+int main() {
+  measure("shmqueue spsc", run_shmqueue<shm_mode::spsc>);
+  measure("shmqueue mpmc", run_shmqueue<shm_mode::mpmc>);
+  measure("socketpair", run_socketpair);
+}
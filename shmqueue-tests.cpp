@@ -0,0 +1,198 @@
+#include <string>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "catch.hpp"
+#include "shmqueue.hpp"
+
+using gto::shmqueue;
+using gto::shm_mode;
+
+namespace {
+
+struct message {
+  std::uint64_t id;
+  double value;
+};
+
+} // unnamed namespace
+
+TEST_CASE("shmqueue") {
+
+  SECTION("capacity") {
+    CHECK(shmqueue<int>::create_anonymous(1).capacity() == 1);
+    CHECK(shmqueue<int>::create_anonymous(100).capacity() == 128);
+    CHECK(shmqueue<int>::create_anonymous(128).capacity() == 128);
+    CHECK_THROWS_AS(shmqueue<int>::create_anonymous(0), std::length_error);
+  }
+
+  SECTION("push-pop") {
+    auto queue = shmqueue<int>::create_anonymous(4);
+    CHECK(queue.empty());
+    CHECK(!queue.try_pop().has_value());
+    for (int i = 0; i < 4; i++) {
+      CHECK(queue.try_push(i));
+    }
+    CHECK(queue.size() == 4);
+    CHECK(!queue.try_push(4));
+    int val = -1;
+    CHECK(queue.try_pop(val));
+    CHECK(val == 0);
+    CHECK(queue.try_push(4));
+    // wrapped
+    for (int i = 1; i <= 4; i++) {
+      CHECK(queue.try_pop() == i);
+    }
+    CHECK(queue.empty());
+    CHECK(!queue.try_pop(val));
+  }
+
+  SECTION("named") {
+    std::string name = "/cqueue-tests-" + std::to_string(::getpid());
+    shmqueue<message>::unlink(name);
+    auto producer = shmqueue<message>::create(name, 16);
+    CHECK_THROWS_AS(shmqueue<message>::create(name, 16), std::system_error);
+    CHECK_THROWS_AS(shmqueue<int>::open(name), std::invalid_argument);
+    auto consumer = shmqueue<message>::open(name);
+    CHECK(consumer.capacity() == 16);
+    CHECK(producer.try_push(message{1, 2.5}));
+    CHECK(consumer.size() == 1);
+    auto msg = consumer.try_pop();
+    REQUIRE(msg.has_value());
+    CHECK(msg->id == 1);
+    CHECK(msg->value == 2.5);
+    CHECK(shmqueue<message>::unlink(name));
+    CHECK(!shmqueue<message>::unlink(name));
+    CHECK_THROWS_AS(shmqueue<message>::open(name), std::system_error);
+    // mappings remain valid
+    CHECK(producer.try_push(message{2, 0.0}));
+    CHECK(consumer.try_pop().has_value());
+  }
+
+  SECTION("create failure") {
+    std::string name = "/cqueue-tests-fail-" + std::to_string(::getpid());
+    shmqueue<message>::unlink(name);
+    pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      // child: limit address space so that mapping the segment fails
+      std::size_t pages = 0;
+      std::ifstream("/proc/self/statm") >> pages;
+      rlimit limit{};
+      limit.rlim_cur = limit.rlim_max = static_cast<rlim_t>(pages) * static_cast<rlim_t>(::sysconf(_SC_PAGESIZE)) + (64 << 20);
+      if (::setrlimit(RLIMIT_AS, &limit) != 0) ::_exit(2);
+      try {
+        shmqueue<message>::create(name, 1 << 26);
+        ::_exit(3);
+      }
+      catch (const std::system_error &) {
+        // object removed, so a retry succeeds
+      }
+      ::_exit(shmqueue<message>::unlink(name) ? 1 : 0);
+    }
+    int status = -1;
+    ::waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    CHECK(!shmqueue<message>::unlink(name));
+  }
+
+  SECTION("move") {
+    auto queue1 = shmqueue<int>::create_anonymous(8);
+    queue1.try_push(1);
+    int fd = queue1.fd();
+    auto queue2 = std::move(queue1);
+    CHECK(queue1.fd() == -1);
+    CHECK(queue2.fd() == fd);
+    CHECK(queue2.try_pop() == 1);
+    // moved-from queue is empty, without slots
+    CHECK(queue1.capacity() == 0);
+    CHECK(queue1.size() == 0);
+    CHECK(queue1.empty());
+    CHECK(!queue1.try_push(2));
+    CHECK(!queue1.try_pop().has_value());
+  }
+
+  SECTION("interprocess") {
+    constexpr std::uint64_t N = 200'000;
+    auto queue = shmqueue<message, shm_mode::spsc>::create_anonymous(1024);
+    pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      // child (producer)
+      for (std::uint64_t i = 0; i < N; i++) {
+        while (!queue.try_push(message{i, static_cast<double>(i)})) {
+          std::this_thread::yield();
+        }
+      }
+      ::_exit(0);
+    }
+    // parent (consumer)
+    bool ordered = true;
+    for (std::uint64_t i = 0; i < N; i++) {
+      message msg{};
+      while (!queue.try_pop(msg)) {
+        std::this_thread::yield();
+      }
+      ordered = ordered && (msg.id == i) && (msg.value == static_cast<double>(i));
+    }
+    int status = -1;
+    ::waitpid(pid, &status, 0);
+    CHECK(ordered);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    CHECK(queue.empty());
+  }
+
+  SECTION("mpmc") {
+    constexpr std::uint64_t N = 100'000;
+    constexpr std::size_t NUM_THREADS = 2;
+    auto queue = shmqueue<std::uint64_t>::create_anonymous(64);
+    std::atomic<std::uint64_t> consumed = 0;
+    std::vector<std::vector<std::uint64_t>> items(NUM_THREADS);
+    std::vector<std::thread> threads;
+
+    for (std::size_t t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&queue, t]() {
+        // each thread maps the segment on its own
+        auto mapping = shmqueue<std::uint64_t>::from_fd(queue.fd());
+        for (std::uint64_t i = t; i < N; i += NUM_THREADS) {
+          while (!mapping.try_push(i)) {
+            std::this_thread::yield();
+          }
+        }
+      });
+      threads.emplace_back([&queue, &consumed, &items = items[t]]() {
+        auto mapping = shmqueue<std::uint64_t>::from_fd(queue.fd());
+        while (consumed.load() < N) {
+          if (auto val = mapping.try_pop()) {
+            items.push_back(*val);
+            consumed++;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::vector<bool> seen(N, false);
+    std::size_t count = 0;
+    for (auto &vals : items) {
+      for (auto val : vals) {
+        REQUIRE(val < N);
+        REQUIRE(!seen[val]);
+        seen[val] = true;
+        count++;
+      }
+    }
+    CHECK(count == N);
+    CHECK(queue.empty());
+  }
+
+}
@@ -0,0 +1,509 @@
+#pragma once
+
+#include <new>
+#include <atomic>
+#include <limits>
+#include <string>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cqueue.hpp"
+
+namespace gto {
+
+//! Concurrency mode of shmqueue.
+enum class shm_mode {
+  //! Single producer, single consumer.
+  spsc,
+  //! Multiple producers, multiple consumers.
+  mpmc
+};
+
+/**
+ * @brief Bounded interprocess queue living in a shared memory mapping.
+ *
+ * @details The queue header (positions and capacity) and the slots are
+ *          stored in a POSIX shared memory object (shm_open) or in an
+ *          anonymous memory file (memfd_create) mapped by each process.
+ *          Slots are addressed by offset from the mapping start, so each
+ *          process can map the segment at a different address.
+ *          Each slot has a sequence number telling whether it is ready to
+ *          be written or read (Vyukov's bounded queue). Push and pop are
+ *          lock-free and don't do syscalls. In SPSC mode positions are
+ *          updated with plain stores instead of compare-and-swap.
+ *          Capacity is rounded up to a power of 2.
+ *
+ * @note Each process must use its own shmqueue object (mapping). All of
+ *       them must use the same T and mode.
+ *
+ * @see https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ *
+ * @tparam T Elements type (trivially copyable).
+ * @tparam Mode Concurrency mode.
+ */
+template<typename T, shm_mode Mode = shm_mode::mpmc>
+  requires std::is_trivially_copyable_v<T>
+class shmqueue
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+  private: // declarations
+
+    //! Cache line size (avoid false sharing between positions).
+    static constexpr std::size_t CACHE_LINE = 64;
+    //! Segment identifier.
+    static constexpr std::uint64_t MAGIC = 0x65756575716d6873; // "shmqueue"
+
+    //! Slot stored in the segment.
+    struct slot {
+      //! Slot state (pos = writable at pos, pos+1 = readable at pos).
+      std::atomic<std::uint64_t> sequence;
+      //! Slot value.
+      T value;
+    };
+
+    //! Segment header (followed by slots).
+    struct header {
+      //! Segment identifier (published last, release/acquire).
+      std::atomic<std::uint64_t> magic;
+      //! Number of slots (power of 2).
+      std::uint64_t capacity;
+      //! Size of a slot (checks T compatibility).
+      std::uint64_t slot_size;
+      //! Offset of the first slot from the segment start.
+      std::uint64_t slots_offset;
+      //! Position of the next pushed item.
+      alignas(CACHE_LINE) std::atomic<std::uint64_t> back;
+      //! Position of the front item.
+      alignas(CACHE_LINE) std::atomic<std::uint64_t> front;
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "lock-free atomics required");
+    static_assert(std::is_trivially_destructible_v<header>);
+
+  private: // members
+
+    //! File descriptor of the shared memory object.
+    int mFd = -1;
+    //! Mapping start.
+    void *mAddr = nullptr;
+    //! Mapping size.
+    std::size_t mLength = 0;
+
+  private: // static methods
+
+    //! Compute slots offset.
+    static constexpr std::size_t getSlotsOffset() noexcept;
+    //! Compute segment size.
+    static constexpr std::size_t getSegmentSize(size_type capacity) noexcept;
+    //! Round up capacity to a power of 2 (throw exception if invalid).
+    static size_type getCapacity(size_type capacity);
+    //! Throw a system error.
+    [[noreturn]] static void fail(const char *what);
+
+  private: // methods
+
+    //! Constructor (takes ownership of fd).
+    explicit shmqueue(int fd);
+    //! Map the segment of mFd.
+    void map();
+    //! Map the segment of mFd and check it is a compatible queue.
+    void attach();
+    //! Initialize segment.
+    void init(size_type capacity) noexcept;
+    //! Return the segment header.
+    header & getHeader() const noexcept { return *static_cast<header *>(mAddr); }
+    //! Return the slot at pos.
+    slot & getSlot(std::uint64_t pos) const noexcept;
+    //! Remove the front item copying it to dst.
+    bool pop(void *dst) noexcept;
+
+  public: // static methods
+
+    //! Create a named shared memory queue.
+    static shmqueue create(const std::string &name, size_type capacity);
+    //! Open an existing named shared memory queue.
+    static shmqueue open(const std::string &name);
+    //! Create an anonymous shared memory queue (share fd() with child or via SCM_RIGHTS).
+    static shmqueue create_anonymous(size_type capacity);
+    //! Open a queue from a file descriptor (fd is duplicated).
+    static shmqueue from_fd(int fd);
+    //! Remove a named shared memory queue (existing mappings remain valid).
+    static bool unlink(const std::string &name) noexcept { return (::shm_unlink(name.c_str()) == 0); }
+
+  public: // methods
+
+    //! Move constructor.
+    shmqueue(shmqueue &&other) noexcept { swap(other); }
+    //! Move assignment.
+    shmqueue & operator=(shmqueue &&other) noexcept { swap(other); return *this; }
+    //! Non-copyable.
+    shmqueue(const shmqueue &) = delete;
+    //! Non-copyable.
+    shmqueue & operator=(const shmqueue &) = delete;
+    //! Destructor (unmaps the segment, data persists while mapped or named).
+    ~shmqueue();
+
+    //! File descriptor of the shared memory object.
+    int fd() const noexcept { return mFd; }
+    //! Return queue capacity (0 if moved-from).
+    size_type capacity() const noexcept { return (mAddr == nullptr ? 0 : static_cast<size_type>(getHeader().capacity)); }
+    //! Approximate number of items.
+    size_type size() const noexcept;
+    //! Check if there are items (approximate).
+    [[nodiscard]] bool empty() const noexcept { return (size() == 0); }
+    //! Swap content.
+    void swap(shmqueue &other) noexcept;
+
+    //! Insert an item at the back (false if full).
+    bool try_push(const T &val) noexcept;
+    //! Remove the front item moving it to val (false if empty).
+    bool try_pop(T &val) noexcept { return pop(&val); }
+    //! Remove the front item (nullopt if empty).
+    std::optional<T> try_pop() noexcept;
+};
+
+} // namespace gto
+
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+constexpr std::size_t gto::shmqueue<T, Mode>::getSlotsOffset() noexcept {
+  constexpr std::size_t align = alignof(slot);
+  return (sizeof(header) + align - 1) / align * align;
+}
+
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+constexpr std::size_t gto::shmqueue<T, Mode>::getSegmentSize(size_type capacity) noexcept {
+  return getSlotsOffset() + capacity * sizeof(slot);
+}
+
+/**
+ * @param[in] capacity Requested capacity.
+ * @return Number of slots.
+ * @exception std::length_error Invalid capacity.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+auto gto::shmqueue<T, Mode>::getCapacity(size_type capacity) -> size_type {
+  if (capacity == 0 || capacity > (std::numeric_limits<std::uint32_t>::max() / sizeof(slot))) {
+    CQUEUE_THROW(std::length_error("shmqueue invalid capacity"));
+  }
+  size_type ret = 1;
+  while (ret < capacity) {
+    ret *= 2;
+  }
+  return ret;
+}
+
+/**
+ * @param[in] what Failed function.
+ * @exception std::system_error Always (aborts when exceptions are disabled).
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+void gto::shmqueue<T, Mode>::fail(const char *what) {
+  CQUEUE_THROW(std::system_error(errno, std::generic_category(), what));
+  std::abort();
+}
+
+/**
+ * @param[in] fd File descriptor (closed on destruction).
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+gto::shmqueue<T, Mode>::shmqueue(int fd) : mFd{fd} {}
+
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+gto::shmqueue<T, Mode>::~shmqueue() {
+  if (mAddr != nullptr) {
+    ::munmap(mAddr, mLength);
+  }
+  if (mFd >= 0) {
+    ::close(mFd);
+  }
+}
+
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+void gto::shmqueue<T, Mode>::swap(shmqueue &other) noexcept {
+  std::swap(mFd, other.mFd);
+  std::swap(mAddr, other.mAddr);
+  std::swap(mLength, other.mLength);
+}
+
+/**
+ * @details Mapping size is the object size.
+ * @exception std::system_error Mapping failed.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+void gto::shmqueue<T, Mode>::map() {
+  struct stat st{};
+  if (::fstat(mFd, &st) != 0) {
+    fail("fstat");
+  }
+  auto len = static_cast<std::size_t>(st.st_size);
+  void *addr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+  if (addr == MAP_FAILED) {
+    fail("mmap");
+  }
+  mAddr = addr;
+  mLength = len;
+}
+
+/**
+ * @exception std::system_error Mapping failed.
+ * @exception std::invalid_argument Segment is not a compatible queue.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+void gto::shmqueue<T, Mode>::attach() {
+  map();
+  const header &hdr = getHeader();
+  if (mLength < sizeof(header) || hdr.magic.load(std::memory_order_acquire) != MAGIC || hdr.slot_size != sizeof(slot) ||
+      mLength < getSegmentSize(static_cast<size_type>(hdr.capacity))) {
+    CQUEUE_THROW(std::invalid_argument("shmqueue incompatible segment"));
+  }
+}
+
+/**
+ * @details Header and slot sequences are constructed in place. Called
+ *          once, before the segment is shared.
+ * @param[in] capacity Number of slots (power of 2).
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+void gto::shmqueue<T, Mode>::init(size_type capacity) noexcept {
+  header *hdr = static_cast<header *>(mAddr);
+  std::construct_at(&hdr->magic, 0);
+  hdr->capacity = capacity;
+  hdr->slot_size = sizeof(slot);
+  hdr->slots_offset = getSlotsOffset();
+  std::construct_at(&hdr->back, 0);
+  std::construct_at(&hdr->front, 0);
+  for (std::uint64_t i = 0; i < capacity; ++i) {
+    std::construct_at(&getSlot(i).sequence, i);
+  }
+  hdr->magic.store(MAGIC, std::memory_order_release);
+}
+
+/**
+ * @param[in] pos Position (not masked).
+ * @return Slot storing the item at pos.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+auto gto::shmqueue<T, Mode>::getSlot(std::uint64_t pos) const noexcept -> slot & {
+  const header &hdr = getHeader();
+  auto *base = static_cast<std::byte *>(mAddr) + hdr.slots_offset;
+  return reinterpret_cast<slot *>(base)[pos & (hdr.capacity - 1)];
+}
+
+/**
+ * @param[in] name Shared memory object name (eg. "/myqueue").
+ * @param[in] capacity Queue capacity (rounded up to a power of 2).
+ * @return Queue mapping the new object.
+ * @exception std::system_error Object exists or can not be created.
+ * @exception std::length_error Invalid capacity.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+auto gto::shmqueue<T, Mode>::create(const std::string &name, size_type capacity) -> shmqueue {
+  size_type len = getCapacity(capacity);
+  int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    fail("shm_open");
+  }
+  shmqueue ret(fd);
+  CQUEUE_TRY {
+    if (::ftruncate(fd, static_cast<off_t>(getSegmentSize(len))) != 0) {
+      fail("ftruncate");
+    }
+    ret.map();
+  } CQUEUE_CATCH_ALL {
+    // a leftover object would make every retry fail (O_EXCL)
+    ::shm_unlink(name.c_str());
+    CQUEUE_RETHROW;
+  }
+  ret.init(len);
+  return ret;
+}
+
+/**
+ * @param[in] name Shared memory object name.
+ * @return Queue mapping the existing object.
+ * @exception std::system_error Object can not be opened or mapped.
+ * @exception std::invalid_argument Object is not a compatible queue.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+auto gto::shmqueue<T, Mode>::open(const std::string &name) -> shmqueue {
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    fail("shm_open");
+  }
+  shmqueue ret(fd);
+  ret.attach();
+  return ret;
+}
+
+/**
+ * @param[in] capacity Queue capacity (rounded up to a power of 2).
+ * @return Queue mapping a new anonymous memory file.
+ * @exception std::system_error Memory file can not be created.
+ * @exception std::length_error Invalid capacity.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+auto gto::shmqueue<T, Mode>::create_anonymous(size_type capacity) -> shmqueue {
+  size_type len = getCapacity(capacity);
+  int fd = ::memfd_create("shmqueue", 0);
+  if (fd < 0) {
+    fail("memfd_create");
+  }
+  shmqueue ret(fd);
+  if (::ftruncate(fd, static_cast<off_t>(getSegmentSize(len))) != 0) {
+    fail("ftruncate");
+  }
+  ret.map();
+  ret.init(len);
+  return ret;
+}
+
+/**
+ * @param[in] fd File descriptor of a queue segment (not closed).
+ * @return Queue mapping the segment.
+ * @exception std::system_error Descriptor can not be duplicated or mapped.
+ * @exception std::invalid_argument Segment is not a compatible queue.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+auto gto::shmqueue<T, Mode>::from_fd(int fd) -> shmqueue {
+  int dup = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (dup < 0) {
+    fail("fcntl");
+  }
+  shmqueue ret(dup);
+  ret.attach();
+  return ret;
+}
+
+/**
+ * @details Value can be outdated when called concurrently.
+ *          A moved-from queue has no items.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+auto gto::shmqueue<T, Mode>::size() const noexcept -> size_type {
+  if (mAddr == nullptr) {
+    return 0;
+  }
+  const header &hdr = getHeader();
+  std::uint64_t front = hdr.front.load(std::memory_order_relaxed);
+  std::uint64_t back = hdr.back.load(std::memory_order_relaxed);
+  return static_cast<size_type>(back > front ? back - front : 0);
+}
+
+/**
+ * @param[in] val Value to add.
+ * @return true = inserted, false = queue full (or moved-from).
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+bool gto::shmqueue<T, Mode>::try_push(const T &val) noexcept {
+  if (mAddr == nullptr) {
+    return false;
+  }
+  header &hdr = getHeader();
+  std::uint64_t pos = hdr.back.load(std::memory_order_relaxed);
+  slot *ptr = nullptr;
+
+  while (true) {
+    ptr = &getSlot(pos);
+    std::uint64_t seq = ptr->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<std::int64_t>(seq - pos);
+    if (diff == 0) {
+      if constexpr (Mode == shm_mode::spsc) {
+        hdr.back.store(pos + 1, std::memory_order_relaxed);
+        break;
+      } else if (hdr.back.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // full
+      return false;
+    } else {
+      pos = hdr.back.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::memcpy(static_cast<void *>(&ptr->value), &val, sizeof(T));
+  ptr->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @param[out] dst Storage of the removed element (sizeof(T) bytes).
+ * @return true = removed, false = queue empty (or moved-from).
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+bool gto::shmqueue<T, Mode>::pop(void *dst) noexcept {
+  if (mAddr == nullptr) {
+    return false;
+  }
+  header &hdr = getHeader();
+  std::uint64_t pos = hdr.front.load(std::memory_order_relaxed);
+  slot *ptr = nullptr;
+
+  while (true) {
+    ptr = &getSlot(pos);
+    std::uint64_t seq = ptr->sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<std::int64_t>(seq - (pos + 1));
+    if (diff == 0) {
+      if constexpr (Mode == shm_mode::spsc) {
+        hdr.front.store(pos + 1, std::memory_order_relaxed);
+        break;
+      } else if (hdr.front.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // empty
+      return false;
+    } else {
+      pos = hdr.front.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::memcpy(dst, &ptr->value, sizeof(T));
+  ptr->sequence.store(pos + hdr.capacity, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @return Removed element, or nullopt if the queue is empty.
+ */
+template<typename T, gto::shm_mode Mode>
+  requires std::is_trivially_copyable_v<T>
+std::optional<T> gto::shmqueue<T, Mode>::try_pop() noexcept {
+  alignas(T) std::byte buf[sizeof(T)];
+  if (!pop(buf)) {
+    return std::nullopt;
+  }
+  return *std::launder(reinterpret_cast<T *>(buf));
+}
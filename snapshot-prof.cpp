@@ -0,0 +1,86 @@
+#include "cqueue.hpp"
+#include "snapshot.hpp"
+
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define DEFAULT_SIZE_MB 256
+#define SNAPSHOT_PATH "/tmp/snapshot-prof.bin"
+
+// g++ -std=c++20 -O3 -o snapshot-prof snapshot-prof.cpp
+// ./snapshot-prof [size-in-MB]
+// Saves and restores a queue of uint64 (wrapped buffer) using the snapshot
+// functions and element-wise streaming through iterators (baseline).
+
+using namespace gto;
+
+template<typename Fn>
+void measure(const char *name, std::size_t bytes, Fn fn) {
+  auto t1 = std::chrono::steady_clock::now();
+  fn();
+  auto t2 = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+  std::cout
+      << name << " elapsed time in microseconds : " << us << " µs ("
+      << (us > 0 ? static_cast<double>(bytes) / static_cast<double>(us) : 0.0) << " MB/s)\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t size_mb = (argc > 1 ? std::stoul(argv[1]) : DEFAULT_SIZE_MB);
+  std::size_t n = size_mb * 1024 * 1024 / sizeof(std::uint64_t);
+  std::size_t bytes = n * sizeof(std::uint64_t);
+
+  cqueue<std::uint64_t> queue;
+  queue.reserve(n);
+  for (std::size_t i = 0; i < n / 2; i++) queue.push(0);
+  for (std::size_t i = 0; i < n / 2; i++) queue.pop();
+  for (std::uint64_t i = 0; i < n; i++) queue.push(i);
+
+  measure("save (writev)", bytes, [&]() {
+    int fd = ::open(SNAPSHOT_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    save(queue, fd);
+    ::close(fd);
+  });
+
+  measure("load (readv)", bytes, [&]() {
+    cqueue<std::uint64_t> restored;
+    int fd = ::open(SNAPSHOT_PATH, O_RDONLY);
+    load(restored, fd);
+    ::close(fd);
+    if (restored.size() != n || restored.back() != n - 1) {
+      std::cerr << "error: wrong content" << std::endl;
+    }
+  });
+
+  measure("save (element-wise)", bytes, [&]() {
+    std::ofstream os(SNAPSHOT_PATH, std::ios::binary);
+    std::uint64_t len = queue.size();
+    os.write(reinterpret_cast<const char *>(&len), sizeof(len));
+    for (const auto &item : queue) {
+      os.write(reinterpret_cast<const char *>(&item), sizeof(item));
+    }
+  });
+
+  measure("load (element-wise)", bytes, [&]() {
+    cqueue<std::uint64_t> restored;
+    std::ifstream is(SNAPSHOT_PATH, std::ios::binary);
+    std::uint64_t len = 0;
+    is.read(reinterpret_cast<char *>(&len), sizeof(len));
+    for (std::uint64_t i = 0; i < len; i++) {
+      std::uint64_t item = 0;
+      is.read(reinterpret_cast<char *>(&item), sizeof(item));
+      restored.push_back(item);
+    }
+    if (restored.size() != n || restored.back() != n - 1) {
+      std::cerr << "error: wrong content" << std::endl;
+    }
+  });
+
+  std::remove(SNAPSHOT_PATH);
+}
@@ -0,0 +1,136 @@
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "catch.hpp"
+#include "snapshot.hpp"
+
+using gto::cqueue;
+
+namespace {
+
+struct point {
+  int x;
+  double y;
+  bool operator==(const point &other) const = default;
+};
+
+// fills queue with values [from, to) wrapping the buffer
+cqueue<std::uint64_t> make_wrapped(std::uint64_t from, std::uint64_t to) {
+  cqueue<std::uint64_t> queue;
+  queue.reserve(16);
+  for (std::uint64_t i = 0; i < 12; i++) queue.push(0);
+  for (std::uint64_t i = 0; i < 12; i++) queue.pop();
+  for (std::uint64_t i = from; i < to; i++) queue.push(i);
+  return queue;
+}
+
+} // unnamed namespace
+
+TEST_CASE("snapshot") {
+
+  SECTION("fd") {
+    std::string path = "/tmp/cqueue-tests-" + std::to_string(::getpid()) + "-snapshot";
+    auto queue1 = make_wrapped(100, 110);
+    REQUIRE(!queue1.spans().second.empty());
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    REQUIRE(fd >= 0);
+    gto::save(queue1, fd);
+    gto::save(cqueue<std::uint64_t>{}, fd);
+    ::lseek(fd, 0, SEEK_SET);
+
+    cqueue<std::uint64_t> queue2{1, 2, 3};
+    gto::load(queue2, fd);
+    CHECK(queue2.size() == 10);
+    CHECK(queue2.reserved() == 10);
+    CHECK(std::equal(queue1.begin(), queue1.end(), queue2.begin(), queue2.end()));
+    gto::load(queue2, fd);
+    CHECK(queue2.empty());
+    // end of file
+    CHECK_THROWS_AS(gto::load(queue2, fd), std::runtime_error);
+
+    // incompatible type
+    ::lseek(fd, 0, SEEK_SET);
+    cqueue<std::uint32_t> queue3;
+    CHECK_THROWS_AS(gto::load(queue3, fd), std::invalid_argument);
+
+    // capacity exceeded
+    ::lseek(fd, 0, SEEK_SET);
+    cqueue<std::uint64_t> queue4(4);
+    CHECK_THROWS_AS(gto::load(queue4, fd), std::length_error);
+
+    // truncated
+    REQUIRE(::ftruncate(fd, 24 + 5 * 8) == 0);
+    ::lseek(fd, 0, SEEK_SET);
+    CHECK_THROWS_AS(gto::load(queue2, fd), std::runtime_error);
+    CHECK(queue2.empty());
+
+    ::close(fd);
+    std::remove(path.c_str());
+  }
+
+  SECTION("pipe") {
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    cqueue<point> queue1;
+    queue1.push({1, 1.5});
+    queue1.push({2, 2.5});
+    gto::save(queue1, fds[1]);
+    ::close(fds[1]);
+    cqueue<point> queue2;
+    gto::load(queue2, fds[0]);
+    ::close(fds[0]);
+    CHECK(queue2.size() == 2);
+    CHECK(queue2[1] == point{2, 2.5});
+  }
+
+  SECTION("stream") {
+    auto queue1 = make_wrapped(0, 10);
+    std::stringstream ss;
+    gto::save(queue1, ss);
+    cqueue<std::uint64_t> queue2;
+    gto::load(queue2, ss);
+    CHECK(std::equal(queue1.begin(), queue1.end(), queue2.begin(), queue2.end()));
+    CHECK_THROWS_AS(gto::load(queue2, ss), std::runtime_error);
+    std::stringstream empty;
+    CHECK_THROWS_AS(gto::load(queue2, empty), std::runtime_error);
+  }
+
+  SECTION("serializer") {
+    cqueue<std::string> queue1{"hello", "", "world"};
+    std::stringstream ss;
+    auto serialize = [](std::ostream &os, const std::string &str) {
+      auto len = static_cast<std::uint32_t>(str.size());
+      os.write(reinterpret_cast<const char *>(&len), sizeof(len));
+      os.write(str.data(), len);
+    };
+    auto deserialize = [](std::istream &is) {
+      std::uint32_t len = 0;
+      is.read(reinterpret_cast<char *>(&len), sizeof(len));
+      std::string str(len, '\0');
+      is.read(str.data(), len);
+      return str;
+    };
+    gto::save(queue1, ss, serialize);
+    std::string data = ss.str();
+    cqueue<std::string> queue2;
+    gto::load(queue2, ss, deserialize);
+    CHECK(queue2.size() == 3);
+    CHECK(queue2.reserved() == 3);
+    CHECK(queue2[0] == "hello");
+    CHECK(queue2[1] == "");
+    CHECK(queue2[2] == "world");
+    // truncated
+    std::stringstream truncated(data.substr(0, data.size() - 2));
+    CHECK_THROWS_AS(gto::load(queue2, truncated, deserialize), std::runtime_error);
+    CHECK(queue2.empty());
+    // raw snapshot is not a serialized one
+    std::stringstream raw;
+    gto::save(cqueue<int>{1}, raw);
+    CHECK_THROWS_AS(gto::load(queue2, raw, deserialize), std::invalid_argument);
+  }
+
+}
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "cqueue.hpp"
+
+// Binary snapshots of a cqueue.
+// Format: header (magic, item size, length) followed by the items. Trivially
+// copyable items are written as raw bytes (native layout and endianness),
+// otherwise item size is 0 and items are written by a user serializer.
+
+namespace gto {
+
+namespace detail {
+
+//! Snapshot file header.
+struct snapshot_header {
+  //! Snapshot identifier.
+  std::uint64_t magic = 0x313070616e737163; // "cqsnap01"
+  //! Item size (0 = serialized items).
+  std::uint64_t item_size = 0;
+  //! Number of items.
+  std::uint64_t length = 0;
+};
+
+/**
+ * @details Repeats the readv()/writev() call until all data is transferred
+ *          (partial transfers and EINTR).
+ * @param[in] fn readv or writev.
+ * @param[in] fd File descriptor.
+ * @param[in] iov Buffers (modified).
+ * @param[in] iovcnt Number of buffers.
+ * @exception std::system_error I/O error.
+ * @exception std::runtime_error Unexpected end of file.
+ */
+template<typename Fn>
+void transfer_all(Fn fn, int fd, iovec *iov, int iovcnt) {
+  while (iovcnt > 0) {
+    if (iov->iov_len == 0) {
+      ++iov;
+      --iovcnt;
+      continue;
+    }
+    ssize_t rc = fn(fd, iov, iovcnt);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      CQUEUE_THROW(std::system_error(errno, std::generic_category(), "cqueue snapshot"));
+    }
+    if (rc == 0) {
+      CQUEUE_THROW(std::runtime_error("cqueue snapshot truncated"));
+    }
+    auto len = static_cast<std::size_t>(rc);
+    while (iovcnt > 0 && len >= iov->iov_len) {
+      len -= iov->iov_len;
+      ++iov;
+      --iovcnt;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<std::byte *>(iov->iov_base) + len;
+      iov->iov_len -= len;
+    }
+  }
+}
+
+/**
+ * @param[in] hdr Header read.
+ * @param[in] item_size Expected item size.
+ * @exception std::invalid_argument Not a snapshot or incompatible items.
+ */
+inline void check_header(const snapshot_header &hdr, std::size_t item_size) {
+  if (hdr.magic != snapshot_header{}.magic || hdr.item_size != item_size) {
+    CQUEUE_THROW(std::invalid_argument("cqueue snapshot incompatible"));
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief Save the queue content to a file descriptor.
+ * @details Header and the (at most two) contiguous segments are written
+ *          with a single writev() call (repeated on partial writes).
+ * @param[in] queue Queue to save.
+ * @param[in] fd File descriptor (file, pipe, socket, ...).
+ * @exception std::system_error Write error.
+ */
+template<typename T, typename Allocator, typename Stats>
+  requires std::is_trivially_copyable_v<T>
+void save(const cqueue<T, Allocator, Stats> &queue, int fd) {
+  detail::snapshot_header hdr{};
+  hdr.item_size = sizeof(T);
+  hdr.length = queue.size();
+  auto [seg1, seg2] = queue.spans();
+  iovec iov[3] = {
+    {&hdr, sizeof(hdr)},
+    {const_cast<T *>(seg1.data()), seg1.size_bytes()},
+    {const_cast<T *>(seg2.data()), seg2.size_bytes()}
+  };
+  detail::transfer_all(::writev, fd, iov, 3);
+}
+
+/**
+ * @brief Replace the queue content by a snapshot read from a file descriptor.
+ * @details Memory is allocated once at the exact snapshot size (or the
+ *          current buffer is reused if big enough) and items are read in
+ *          place with readv(). On error the queue is left empty.
+ * @param[in,out] queue Queue to restore.
+ * @param[in] fd File descriptor.
+ * @exception std::system_error Read error.
+ * @exception std::runtime_error Snapshot truncated.
+ * @exception std::invalid_argument Not a snapshot or incompatible items.
+ * @exception std::length_error Snapshot exceeds queue capacity.
+ */
+template<typename T, typename Allocator, typename Stats>
+  requires std::is_trivially_copyable_v<T>
+void load(cqueue<T, Allocator, Stats> &queue, int fd) {
+  detail::snapshot_header hdr{};
+  hdr.magic = 0;
+  iovec iov1[1] = {{&hdr, sizeof(hdr)}};
+  detail::transfer_all(::readv, fd, iov1, 1);
+  detail::check_header(hdr, sizeof(T));
+
+  auto n = static_cast<std::size_t>(hdr.length);
+  queue.clear();
+  queue.reserve(n);
+  auto [seg1, seg2] = queue.prepare_back(n);
+  iovec iov2[2] = {{seg1.data(), seg1.size_bytes()}, {seg2.data(), seg2.size_bytes()}};
+  detail::transfer_all(::readv, fd, iov2, 2);
+  queue.commit_back(n);
+}
+
+/**
+ * @brief Save the queue content to an output stream.
+ * @details Header and the (at most two) contiguous segments are written
+ *          as raw bytes.
+ * @param[in] queue Queue to save.
+ * @param[in] os Output stream (opened in binary mode).
+ * @exception std::runtime_error Write error.
+ */
+template<typename T, typename Allocator, typename Stats>
+  requires std::is_trivially_copyable_v<T>
+void save(const cqueue<T, Allocator, Stats> &queue, std::ostream &os) {
+  detail::snapshot_header hdr{};
+  hdr.item_size = sizeof(T);
+  hdr.length = queue.size();
+  auto [seg1, seg2] = queue.spans();
+  os.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+  os.write(reinterpret_cast<const char *>(seg1.data()), static_cast<std::streamsize>(seg1.size_bytes()));
+  os.write(reinterpret_cast<const char *>(seg2.data()), static_cast<std::streamsize>(seg2.size_bytes()));
+  if (!os) {
+    CQUEUE_THROW(std::runtime_error("cqueue snapshot write error"));
+  }
+}
+
+/**
+ * @brief Replace the queue content by a snapshot read from an input stream.
+ * @details Memory is allocated once at the exact snapshot size (or the
+ *          current buffer is reused if big enough) and items are read in
+ *          place. On error the queue is left empty.
+ * @param[in,out] queue Queue to restore.
+ * @param[in] is Input stream (opened in binary mode).
+ * @exception std::runtime_error Snapshot truncated or read error.
+ * @exception std::invalid_argument Not a snapshot or incompatible items.
+ * @exception std::length_error Snapshot exceeds queue capacity.
+ */
+template<typename T, typename Allocator, typename Stats>
+  requires std::is_trivially_copyable_v<T>
+void load(cqueue<T, Allocator, Stats> &queue, std::istream &is) {
+  detail::snapshot_header hdr{};
+  hdr.magic = 0;
+  if (!is.read(reinterpret_cast<char *>(&hdr), sizeof(hdr))) {
+    CQUEUE_THROW(std::runtime_error("cqueue snapshot truncated"));
+  }
+  detail::check_header(hdr, sizeof(T));
+
+  auto n = static_cast<std::size_t>(hdr.length);
+  queue.clear();
+  queue.reserve(n);
+  auto [seg1, seg2] = queue.prepare_back(n);
+  is.read(reinterpret_cast<char *>(seg1.data()), static_cast<std::streamsize>(seg1.size_bytes()));
+  is.read(reinterpret_cast<char *>(seg2.data()), static_cast<std::streamsize>(seg2.size_bytes()));
+  if (!is) {
+    CQUEUE_THROW(std::runtime_error("cqueue snapshot truncated"));
+  }
+  queue.commit_back(n);
+}
+
+/**
+ * @brief Save the queue content to an output stream using a serializer.
+ * @param[in] queue Queue to save.
+ * @param[in] os Output stream.
+ * @param[in] fn Item serializer, called as fn(os, item).
+ * @exception std::runtime_error Write error.
+ * @exception ... Error throwed by fn.
+ */
+template<typename T, typename Allocator, typename Stats, typename Serializer>
+void save(const cqueue<T, Allocator, Stats> &queue, std::ostream &os, Serializer fn) {
+  detail::snapshot_header hdr{};
+  hdr.length = queue.size();
+  os.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+  for (const T &item : queue) {
+    fn(os, item);
+  }
+  if (!os) {
+    CQUEUE_THROW(std::runtime_error("cqueue snapshot write error"));
+  }
+}
+
+/**
+ * @brief Replace the queue content by a snapshot read using a deserializer.
+ * @details Memory is allocated once at the exact snapshot size (or the
+ *          current buffer is reused if big enough). On error the queue is
+ *          left empty.
+ * @param[in,out] queue Queue to restore.
+ * @param[in] is Input stream.
+ * @param[in] fn Item deserializer, called as fn(is) returning an item.
+ * @exception std::runtime_error Snapshot truncated or read error.
+ * @exception std::invalid_argument Not a snapshot or incompatible items.
+ * @exception std::length_error Snapshot exceeds queue capacity.
+ * @exception ... Error throwed by fn.
+ */
+template<typename T, typename Allocator, typename Stats, typename Deserializer>
+void load(cqueue<T, Allocator, Stats> &queue, std::istream &is, Deserializer fn) {
+  detail::snapshot_header hdr{};
+  hdr.magic = 0;
+  if (!is.read(reinterpret_cast<char *>(&hdr), sizeof(hdr))) {
+    CQUEUE_THROW(std::runtime_error("cqueue snapshot truncated"));
+  }
+  detail::check_header(hdr, 0);
+
+  auto n = static_cast<std::size_t>(hdr.length);
+  queue.clear();
+  queue.reserve(n);
+  CQUEUE_TRY {
+    for (std::size_t i = 0; i < n; ++i) {
+      queue.push_back(fn(is));
+      if (!is) {
+        CQUEUE_THROW(std::runtime_error("cqueue snapshot truncated"));
+      }
+    }
+  } CQUEUE_CATCH_ALL {
+    queue.clear();
+    CQUEUE_RETHROW;
+  }
+}
+
+} // namespace gto
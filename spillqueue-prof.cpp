@@ -0,0 +1,62 @@
+#include "spillqueue.hpp"
+
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <iostream>
+#include <sys/resource.h>
+
+#define DEFAULT_SIZE_MB 1024
+#define MEMORY_BUDGET_MB 64
+#define SEGMENT_MB 8
+
+// g++ -std=c++20 -O3 -pthread -o spillqueue-prof spillqueue-prof.cpp
+// ./spillqueue-prof [backlog-in-MB]
+// Pushes a backlog of uint64 several times bigger than the memory budget
+// and drains it. Max RSS stays close to budget + 3 segments.
+
+using namespace gto;
+
+static long max_rss_mb() {
+  rusage usage{};
+  ::getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024;
+}
+
+template<typename Fn>
+void measure(const char *name, std::size_t bytes, Fn fn) {
+  auto t1 = std::chrono::steady_clock::now();
+  fn();
+  auto t2 = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+  std::cout
+      << name << " elapsed time in microseconds : " << us << " µs ("
+      << (us > 0 ? static_cast<double>(bytes) / static_cast<double>(us) : 0.0) << " MB/s, "
+      << "max rss " << max_rss_mb() << " MB)\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t size_mb = (argc > 1 ? std::stoul(argv[1]) : DEFAULT_SIZE_MB);
+  std::size_t n = size_mb * 1024 * 1024 / sizeof(std::uint64_t);
+  std::size_t bytes = n * sizeof(std::uint64_t);
+
+  spillqueue<std::uint64_t> queue({"/tmp", MEMORY_BUDGET_MB * 1024 * 1024, SEGMENT_MB * 1024 * 1024});
+
+  measure("push", bytes, [&]() {
+    for (std::uint64_t i = 0; i < n; i++) {
+      queue.push(i);
+    }
+  });
+
+  std::cout << "spilled " << queue.spilled() * sizeof(std::uint64_t) / (1024 * 1024) << " MB in "
+            << queue.segments() << " segments\n";
+
+  measure("pop", bytes, [&]() {
+    for (std::uint64_t i = 0; i < n; i++) {
+      if (queue.pop() != i) {
+        std::cerr << "error: wrong order" << std::endl;
+        return;
+      }
+    }
+  });
+}
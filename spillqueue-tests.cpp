@@ -0,0 +1,145 @@
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+#include <unistd.h>
+#include "catch.hpp"
+#include "spillqueue.hpp"
+
+namespace {
+
+// descriptors of the segment files (unnamed files in dir)
+std::vector<int> segment_fds(const std::string &dir) {
+  std::vector<int> ret;
+  for (const auto &entry : std::filesystem::directory_iterator("/proc/self/fd")) {
+    std::error_code ec;
+    auto target = std::filesystem::read_symlink(entry.path(), ec).string();
+    if (!ec && target.starts_with(dir + "/")) {
+      ret.push_back(std::stoi(entry.path().filename().string()));
+    }
+  }
+  return ret;
+}
+
+} // unnamed namespace
+
+using gto::spillqueue;
+using gto::spillqueue_policy;
+
+TEST_CASE("spillqueue") {
+
+  // front: 16 items, segment: 4 items
+  spillqueue_policy policy{"/tmp", 16 * sizeof(std::uint64_t), 4 * sizeof(std::uint64_t)};
+
+  SECTION("in memory") {
+    spillqueue<std::uint64_t> queue(policy);
+    CHECK(queue.empty());
+    CHECK(!queue.try_pop().has_value());
+    CHECK_THROWS_AS(queue.pop(), std::out_of_range);
+    for (std::uint64_t i = 0; i < 16; i++) queue.push(i);
+    CHECK(queue.size() == 16);
+    CHECK(queue.spilled() == 0);
+    CHECK(queue.front() == 0);
+    CHECK(queue.pop() == 0);
+  }
+
+  SECTION("spill and refill") {
+    spillqueue<std::uint64_t> queue(policy);
+    for (std::uint64_t i = 0; i < 1000; i++) {
+      queue.push(i);
+      CHECK(queue.resident() <= 16 + 4);
+    }
+    CHECK(queue.size() == 1000);
+    CHECK(queue.spilled() == 984);
+    CHECK(queue.segments() == 246);
+    for (std::uint64_t i = 0; i < 1000; i++) {
+      REQUIRE(queue.front() == i);
+      REQUIRE(queue.pop() == i);
+      CHECK(queue.resident() <= 16 + 4 + 4);
+    }
+    CHECK(queue.empty());
+    CHECK(queue.segments() == 0);
+    // back in memory mode
+    queue.push(1);
+    CHECK(queue.spilled() == 0);
+    CHECK(queue.pop() == 1);
+  }
+
+  SECTION("interleaved") {
+    spillqueue<std::uint64_t> queue(policy);
+    std::deque<std::uint64_t> expected;
+    std::mt19937 rng(42);
+    std::uint64_t next = 0;
+    for (int i = 0; i < 20000; i++) {
+      // bursts of pushes and pops
+      bool pushing = (i / 500) % 2 == 0;
+      if (rng() % 4 != 0 ? pushing : !pushing) {
+        queue.push(next);
+        expected.push_back(next++);
+      }
+      else if (!expected.empty()) {
+        REQUIRE(queue.pop() == expected.front());
+        expected.pop_front();
+      }
+      else {
+        CHECK(!queue.try_pop().has_value());
+      }
+      REQUIRE(queue.size() == expected.size());
+    }
+    while (auto item = queue.try_pop()) {
+      REQUIRE(*item == expected.front());
+      expected.pop_front();
+    }
+    CHECK(expected.empty());
+  }
+
+  SECTION("read error") {
+    std::string dir = "/tmp/cqueue-tests-spill-" + std::to_string(::getpid());
+    std::filesystem::create_directory(dir);
+    spillqueue<std::uint64_t> queue(spillqueue_policy{dir, 16 * sizeof(std::uint64_t), 4 * sizeof(std::uint64_t)});
+    for (std::uint64_t i = 0; i < 40; i++) {
+      queue.push(i);
+    }
+    REQUIRE(queue.segments() == 6);
+    // corrupt the segments magic
+    auto fds = segment_fds(dir);
+    REQUIRE(fds.size() == 6);
+    std::uint64_t magic = 0;
+    REQUIRE(::pread(fds[0], &magic, sizeof(magic), 0) == sizeof(magic));
+    std::uint64_t bad = ~magic;
+    for (int fd : fds) {
+      REQUIRE(::pwrite(fd, &bad, sizeof(bad), 0) == sizeof(bad));
+    }
+    for (std::uint64_t i = 0; i < 16; i++) {
+      REQUIRE(queue.pop() == i);
+    }
+    // segment kept, can be retried
+    CHECK_THROWS(queue.pop());
+    CHECK(queue.size() == 24);
+    CHECK(queue.spilled() == 24);
+    CHECK(queue.segments() == 6);
+    CHECK_THROWS(queue.front());
+    CHECK(queue.size() == 24);
+    for (int fd : fds) {
+      REQUIRE(::pwrite(fd, &magic, sizeof(magic), 0) == sizeof(magic));
+    }
+    for (std::uint64_t i = 16; i < 40; i++) {
+      REQUIRE(queue.pop() == i);
+    }
+    CHECK(queue.empty());
+    CHECK(segment_fds(dir).empty());
+    std::filesystem::remove(dir);
+  }
+
+  SECTION("invalid") {
+    CHECK_THROWS_AS(spillqueue<std::uint64_t>(spillqueue_policy{"/tmp", 4, 1024}), std::invalid_argument);
+    CHECK_THROWS_AS(spillqueue<std::uint64_t>(spillqueue_policy{"/tmp", 1024, 4}), std::invalid_argument);
+    CHECK_THROWS_AS(spillqueue<std::uint64_t>(spillqueue_policy{"/tmp", 64, 128}), std::invalid_argument);
+    spillqueue<std::uint64_t> queue(spillqueue_policy{"/nonexistent/dir", 8, 8});
+    queue.push(1);
+    CHECK_THROWS_AS(queue.push(2), std::system_error);
+  }
+
+}
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <string>
+#include <future>
+#include <utility>
+#include <cerrno>
+#include <cstdlib>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include "cqueue.hpp"
+#include "snapshot.hpp"
+
+namespace gto {
+
+/**
+ * @brief Memory limits of a spillqueue.
+ */
+struct spillqueue_policy {
+  //! Directory where segment files are created.
+  std::string directory = "/tmp";
+  //! Memory budget of the front queue (bytes).
+  std::size_t memory_bytes = 64 * 1024 * 1024;
+  //! Segment file size (bytes, not greater than memory_bytes).
+  std::size_t segment_bytes = 8 * 1024 * 1024;
+};
+
+/**
+ * @brief FIFO queue spilling to disk the items exceeding a memory budget.
+ *
+ * @details Items are stored in up to four tiers, in FIFO order:
+ *          - front: in-memory cqueue bounded by the memory budget.
+ *          - staging: oldest segment, being loaded asynchronously.
+ *          - segments: files, each one a snapshot of segment_bytes of items.
+ *          - back: in-memory cqueue collecting items to spill.
+ *          Once the front is full, pushed items go to the back, and a full
+ *          back is written to a new segment file. Items go to the front
+ *          again once the spilled tiers are empty.
+ *          When the front drains below one segment, the oldest segment is
+ *          loaded in a background thread (std::async), so it is usually
+ *          ready when the front becomes empty. Segment buffers are reused.
+ *          Resident memory is bounded by memory_bytes + 3 * segment_bytes
+ *          regardless of the queue length.
+ *          Segment files are unnamed (O_TMPFILE) and are removed by the
+ *          system when closed, including on crash. This is not a persistent
+ *          queue.
+ *
+ * @note This class is not thread-safe (like cqueue).
+ *
+ * @tparam T Elements type (trivially copyable).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+class spillqueue
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = value_type &;
+
+  private: // declarations
+
+    //! Spilled items stored in a file.
+    struct segment {
+      //! File descriptor.
+      int fd = -1;
+      //! Number of items.
+      size_type length = 0;
+    };
+
+  private: // members
+
+    //! Memory limits.
+    spillqueue_policy mPolicy;
+    //! Front queue max length.
+    size_type mFrontItems = 0;
+    //! Segment max length.
+    size_type mSegmentItems = 0;
+    //! Front items (oldest).
+    cqueue<T> mFront{};
+    //! Oldest segment being loaded.
+    std::future<cqueue<T>> mStaging{};
+    //! Segment file being loaded (closed once loaded).
+    segment mStagingSegment{};
+    //! Number of items in staging.
+    size_type mStagingLength = 0;
+    //! Spilled segments (oldest first).
+    cqueue<segment> mSegments{};
+    //! Number of items in segments.
+    size_type mSpilled = 0;
+    //! Back items (newest).
+    cqueue<T> mBack{};
+    //! Empty queue whose buffer is reused for loading.
+    cqueue<T> mSpare{};
+
+  private: // static methods
+
+    //! Read a segment file.
+    static cqueue<T> readSegment(int fd, cqueue<T> queue);
+
+  private: // methods
+
+    //! Write back items to a new segment.
+    void spill();
+    //! Start loading the oldest segment.
+    void prefetch();
+    //! Move items to the front (if empty).
+    void refill();
+
+  public: // methods
+
+    //! Constructor.
+    explicit spillqueue(spillqueue_policy policy = {});
+    //! Non-copyable.
+    spillqueue(const spillqueue &) = delete;
+    //! Non-copyable.
+    spillqueue & operator=(const spillqueue &) = delete;
+    //! Destructor.
+    ~spillqueue();
+
+    //! Return the number of items.
+    size_type size() const noexcept { return mFront.size() + mStagingLength + mSpilled + mBack.size(); }
+    //! Check if there are items in the queue.
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    //! Number of items stored in files.
+    size_type spilled() const noexcept { return mSpilled; }
+    //! Number of segment files.
+    size_type segments() const noexcept { return mSegments.size(); }
+    //! Number of items in memory.
+    size_type resident() const noexcept { return mFront.size() + mStagingLength + mBack.size(); }
+
+    //! Insert an item at the end.
+    void push(const T &val);
+    //! Access the first item (waits for the refill if required).
+    reference front();
+    //! Remove the first item.
+    T pop();
+    //! Remove the first item (nullopt if empty).
+    std::optional<T> try_pop();
+};
+
+} // namespace gto
+
+/**
+ * @param[in] policy Memory limits.
+ * @exception std::invalid_argument Item bigger than segment or budget,
+ *            or segment bigger than budget (a loaded segment would not fit).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+gto::spillqueue<T>::spillqueue(spillqueue_policy policy) : mPolicy{std::move(policy)}
+{
+  mFrontItems = mPolicy.memory_bytes / sizeof(T);
+  mSegmentItems = mPolicy.segment_bytes / sizeof(T);
+  if (mFrontItems == 0 || mSegmentItems == 0 || mSegmentItems > mFrontItems) {
+    CQUEUE_THROW(std::invalid_argument("spillqueue invalid policy"));
+  }
+}
+
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+gto::spillqueue<T>::~spillqueue() {
+  if (mStaging.valid()) {
+    mStaging.wait();
+    ::close(mStagingSegment.fd);
+  }
+  for (const segment &seg : mSegments) {
+    ::close(seg.fd);
+  }
+}
+
+/**
+ * @details Runs in a background thread. The file is not closed, so that
+ *          it can be read again if this fails.
+ * @param[in] fd Segment file descriptor.
+ * @param[in] queue Queue whose buffer is reused.
+ * @return Segment items.
+ * @exception std::system_error Read error.
+ * @exception std::runtime_error Truncated segment.
+ * @exception std::invalid_argument Corrupted segment.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::spillqueue<T>::readSegment(int fd, cqueue<T> queue) -> cqueue<T> {
+  if (::lseek(fd, 0, SEEK_SET) < 0) {
+    CQUEUE_THROW(std::system_error(errno, std::generic_category(), "lseek"));
+  }
+  load(queue, fd);
+  return queue;
+}
+
+/**
+ * @details Back items are written to an unnamed file and back is cleared.
+ * @exception std::system_error File can not be created or written.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::spillqueue<T>::spill() {
+  int fd = ::open(mPolicy.directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    CQUEUE_THROW(std::system_error(errno, std::generic_category(), "open"));
+  }
+  CQUEUE_TRY {
+    save(mBack, fd);
+    mSegments.push_back(segment{fd, mBack.size()});
+  } CQUEUE_CATCH_ALL {
+    ::close(fd);
+    CQUEUE_RETHROW;
+  }
+  mSpilled += mBack.size();
+  mBack.clear();
+}
+
+/**
+ * @details Does nothing if a segment is already being loaded.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::spillqueue<T>::prefetch() {
+  if (mStaging.valid() || mSegments.empty()) {
+    return;
+  }
+  segment seg = mSegments.front();
+  mStaging = std::async(std::launch::async, readSegment, seg.fd, std::move(mSpare));
+  mSegments.pop_front();
+  mStagingSegment = seg;
+  mSpilled -= seg.length;
+  mStagingLength = seg.length;
+}
+
+/**
+ * @details When the front is empty it is replaced by the staging segment
+ *          (waiting for it) or by the back items. Then the next segment
+ *          is prefetched. If the staging segment can not be loaded it is
+ *          returned to the segments front (no items lost), so the call
+ *          can be retried.
+ * @exception std::system_error Segment read error.
+ * @exception std::runtime_error Truncated segment.
+ * @exception std::invalid_argument Corrupted segment.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::spillqueue<T>::refill() {
+  if (mFront.empty()) {
+    prefetch();
+    if (mStaging.valid()) {
+      cqueue<T> items;
+      CQUEUE_TRY {
+        items = mStaging.get();
+      } CQUEUE_CATCH_ALL {
+        mSegments.push_front(mStagingSegment);
+        mSpilled += mStagingSegment.length;
+        mStagingSegment = segment{};
+        mStagingLength = 0;
+        CQUEUE_RETHROW;
+      }
+      ::close(mStagingSegment.fd);
+      mStagingSegment = segment{};
+      mStagingLength = 0;
+      mFront.swap(items);
+      mSpare.swap(items);
+    }
+    else if (!mBack.empty()) {
+      mFront.swap(mBack);
+    }
+  }
+  if (mFront.size() <= mSegmentItems) {
+    prefetch();
+  }
+}
+
+/**
+ * @param[in] val Value to add.
+ * @exception std::system_error Segment file error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::spillqueue<T>::push(const T &val) {
+  if (mBack.empty() && mSpilled == 0 && !mStaging.valid() && mFront.size() < mFrontItems) {
+    mFront.push_back(val);
+    return;
+  }
+  mBack.push_back(val);
+  if (mBack.size() >= mSegmentItems) {
+    spill();
+  }
+}
+
+/**
+ * @return Reference to the first item.
+ * @exception std::out_of_range No elements in the queue.
+ * @exception std::system_error Segment read error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::spillqueue<T>::front() -> reference {
+  refill();
+  return mFront.front();
+}
+
+/**
+ * @return Removed element.
+ * @exception std::out_of_range No elements to pop.
+ * @exception std::system_error Segment read error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+T gto::spillqueue<T>::pop() {
+  refill();
+  T ret = mFront.pop_front();
+  if (mFront.size() <= mSegmentItems) {
+    prefetch();
+  }
+  return ret;
+}
+
+/**
+ * @return Removed element, or nullopt if there are no elements in the queue.
+ * @exception std::system_error Segment read error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::spillqueue<T>::try_pop() -> std::optional<T> {
+  if (empty()) {
+    return std::nullopt;
+  }
+  return pop();
+}
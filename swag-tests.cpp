@@ -0,0 +1,202 @@
+#include <deque>
+#include <limits>
+#include <random>
+#include <string>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include "catch.hpp"
+#include "swag.hpp"
+
+using gto::swag;
+using gto::timed_swag;
+
+namespace {
+
+// non-commutative: concatenation
+struct concat {
+  std::string operator()(const std::string &lhs, const std::string &rhs) const { return lhs + rhs; }
+};
+
+struct maximum {
+  int operator()(int lhs, int rhs) const { return std::max(lhs, rhs); }
+};
+
+// mean and variance accumulator
+struct stats {
+  double n = 0;
+  double sum = 0;
+  double sum2 = 0;
+  static stats of(double x) { return {1, x, x * x}; }
+  double mean() const { return sum / n; }
+  double variance() const { return sum2 / n - mean() * mean(); }
+};
+
+struct stats_op {
+  stats operator()(const stats &lhs, const stats &rhs) const {
+    return {lhs.n + rhs.n, lhs.sum + rhs.sum, lhs.sum2 + rhs.sum2};
+  }
+};
+
+// sum counting the calls
+struct counted_sum {
+  std::size_t *calls;
+  long operator()(long lhs, long rhs) const { ++*calls; return lhs + rhs; }
+};
+
+} // unnamed namespace
+
+TEST_CASE("swag") {
+
+  SECTION("sum") {
+    swag<long, std::plus<long>> window(0);
+    CHECK(window.empty());
+    CHECK(window.query() == 0);
+    CHECK_THROWS_AS(window.pop(), std::out_of_range);
+    window.push(1);
+    window.push(2);
+    window.push(3);
+    CHECK(window.size() == 3);
+    CHECK(window.query() == 6);
+    CHECK(window.front() == 1);
+    CHECK(window.back() == 3);
+    window.pop();
+    CHECK(window.query() == 5);
+    window.push(10);
+    CHECK(window.query() == 15);
+    window.clear();
+    CHECK(window.empty());
+    CHECK(window.query() == 0);
+    window.push(4);
+    CHECK(window.query() == 4);
+  }
+
+  SECTION("order") {
+    swag<std::string, concat> window("");
+    std::deque<std::string> expected;
+    std::mt19937 rng(5);
+    char next = 'a';
+    for (int i = 0; i < 5000; i++) {
+      // varying window sizes
+      std::size_t target = (i / 700) % 2 == 0 ? 40 : 3;
+      if (expected.size() < target || rng() % 3 == 0) {
+        std::string item(1, next);
+        next = (next == 'z' ? 'a' : static_cast<char>(next + 1));
+        window.push(item);
+        expected.push_back(item);
+      }
+      else if (!expected.empty()) {
+        window.pop();
+        expected.pop_front();
+      }
+      std::string all;
+      for (const auto &item : expected) all += item;
+      REQUIRE(window.size() == expected.size());
+      REQUIRE(window.query() == all);
+    }
+  }
+
+  SECTION("max") {
+    swag<int, maximum> window(std::numeric_limits<int>::min());
+    std::deque<int> expected;
+    std::mt19937 rng(9);
+    for (int i = 0; i < 10000; i++) {
+      int val = static_cast<int>(rng() % 1000);
+      window.push(val);
+      expected.push_back(val);
+      if (expected.size() > 100) {
+        window.pop();
+        expected.pop_front();
+      }
+      REQUIRE(window.query() == *std::max_element(expected.begin(), expected.end()));
+    }
+  }
+
+  SECTION("worst case") {
+    std::size_t calls = 0;
+    swag<long, counted_sum> window(0, counted_sum{&calls});
+    std::deque<long> expected;
+    std::mt19937 rng(13);
+    std::size_t maxCalls = 0;
+    std::size_t burst = 0;
+    bool pushing = true;
+    for (int i = 0; i < 50000; i++) {
+      // bursts of pushes and pops of random length
+      if (burst == 0) {
+        pushing = (rng() % 2 == 0);
+        burst = 1 + rng() % 300;
+      }
+      burst--;
+      calls = 0;
+      if (pushing || expected.empty()) {
+        long val = static_cast<long>(rng() % 100);
+        window.push(val);
+        expected.push_back(val);
+      }
+      else {
+        window.pop();
+        expected.pop_front();
+      }
+      maxCalls = std::max(maxCalls, calls);
+      REQUIRE(calls <= 3);
+      calls = 0;
+      long result = window.query();
+      REQUIRE(calls <= 3);
+      REQUIRE(result == std::accumulate(expected.begin(), expected.end(), 0L));
+    }
+    CHECK(maxCalls == 3);
+  }
+
+  SECTION("variance") {
+    swag<stats, stats_op> window(stats{});
+    for (double x : {1.0, 2.0, 3.0, 4.0, 100.0}) window.push(stats::of(x));
+    window.pop();
+    window.push(stats::of(5.0));
+    window.pop();
+    // 3, 4, 100, 5
+    auto result = window.query();
+    CHECK(result.n == 4);
+    CHECK(result.mean() == Approx(28.0));
+    CHECK(result.variance() == Approx(1728.5));
+  }
+
+}
+
+TEST_CASE("timed_swag") {
+
+  SECTION("evict_older_than") {
+    timed_swag<long, std::plus<long>, std::int64_t> window(0);
+    CHECK(window.evict_older_than(100) == 0);
+    window.push(10, 1);
+    window.push(20, 2);
+    window.push(20, 3);
+    window.push(35, 4);
+    CHECK_THROWS_AS(window.push(30, 5), std::invalid_argument);
+    CHECK(window.size() == 4);
+    CHECK(window.query() == 10);
+    CHECK(window.oldest() == 10);
+    CHECK(window.newest() == 35);
+    CHECK(window.evict_older_than(20) == 1);
+    CHECK(window.query() == 9);
+    CHECK(window.evict_older_than(21) == 2);
+    CHECK(window.query() == 4);
+    CHECK(window.evict_older_than(1000) == 1);
+    CHECK(window.empty());
+    CHECK(window.query() == 0);
+  }
+
+  SECTION("steady_clock") {
+    using clock = std::chrono::steady_clock;
+    timed_swag<int, maximum> window(std::numeric_limits<int>::min());
+    auto now = clock::now();
+    window.push(now - std::chrono::seconds(10), 50);
+    window.push(now - std::chrono::seconds(2), 7);
+    window.push(now, 3);
+    CHECK(window.query() == 50);
+    CHECK(window.evict_older_than(now - std::chrono::seconds(5)) == 1);
+    CHECK(window.query() == 7);
+  }
+
+}
@@ -0,0 +1,345 @@
+#pragma once
+
+#include <chrono>
+#include <cassert>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <concepts>
+#include <stdexcept>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Sliding-window aggregation for any associative operator.
+ *
+ * @details FIFO window of items (push at back, pop at front) giving the
+ *          aggregate op(x1, op(x2, ..., xn)) of the window items in order.
+ *          The operator must be associative with the given identity; it
+ *          need not be commutative nor invertible (sum, min, max, count,
+ *          mean/variance accumulators, matrix products, ...).
+ *          This is a de-amortized two-stacks aggregator (as DABA): items
+ *          are stored once in a cqueue, split in 3 consecutive parts:
+ *          - front: items with suffix aggregates (popped from here).
+ *          - middle: back items frozen and being turned into suffix
+ *            aggregates, then merged into the front.
+ *          - back: newest items, with their running aggregate.
+ *          Instead of flipping the back when the front is empty (O(n)),
+ *          the flip starts when the back is as long as the front and is
+ *          done incrementally, 2 steps per push/pop, so it always ends
+ *          before the front is empty. push, pop and query call op at most
+ *          3 times (worst case).
+ *
+ * @note Buffer growth is amortized; call reserve() for hard worst-case bounds.
+ * @note This class is not thread-safe (like cqueue).
+ *
+ * @see https://doi.org/10.1145/3093742.3093925
+ *
+ * @tparam T Aggregate type (items are lifted to aggregates by the caller).
+ * @tparam Op Associative binary operator, called as op(lhs, rhs).
+ * @tparam Allocator Allocator.
+ */
+template<std::copyable T, typename Op, typename Allocator = std::allocator<T>>
+  requires std::regular_invocable<Op &, const T &, const T &>
+class swag
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+  private: // declarations
+
+    //! Window item.
+    struct entry {
+      //! Item value.
+      T val;
+      //! Suffix aggregate (front and middle items).
+      T agg;
+    };
+
+    //! Incremental flip phase.
+    enum class phase {
+      //! No flip in progress.
+      idle,
+      //! Computing suffix aggregates of middle items (from its end).
+      rebuild,
+      //! Appending middle aggregate to front aggregates (from its start).
+      merge
+    };
+
+    using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry>;
+
+  private: // members
+
+    //! Window items (front, middle, back).
+    cqueue<entry, entry_allocator> mQueue;
+    //! Aggregation operator.
+    Op mOp;
+    //! Operator identity.
+    T mIdentity;
+    //! Number of front items.
+    size_type mFront = 0;
+    //! Number of middle items.
+    size_type mMiddle = 0;
+    //! Middle items pending (rebuild) or front items done (merge).
+    size_type mCursor = 0;
+    //! Aggregate of middle items.
+    T mAggMiddle;
+    //! Aggregate of back items.
+    T mAggBack;
+    //! Current phase.
+    phase mPhase = phase::idle;
+
+  private: // methods
+
+    //! Aggregate of front items (excluding middle).
+    const T & getAggFront() const;
+    //! Advance the flip one step.
+    void step();
+    //! Start the flip and advance it.
+    void fixup();
+
+  public: // methods
+
+    //! Constructor.
+    explicit swag(const T &identity, const Op &op = Op(), const Allocator &alloc = Allocator()) :
+      mQueue(0, entry_allocator(alloc)), mOp(op), mIdentity(identity), mAggMiddle(identity), mAggBack(identity) {}
+
+    //! Return the number of items in the window.
+    size_type size() const noexcept { return mQueue.size(); }
+    //! Check if window is empty.
+    [[nodiscard]] bool empty() const noexcept { return mQueue.empty(); }
+    //! Allocate memory for n items.
+    void reserve(size_type n) { mQueue.reserve(n); }
+
+    //! Aggregate of the window items (identity if empty).
+    T query() const;
+    //! Access the oldest item.
+    const T & front() const { return mQueue.front().val; }
+    //! Access the newest item.
+    const T & back() const { return mQueue.back().val; }
+    //! Insert an item at the back.
+    void push(const T &val);
+    //! Evict the oldest item.
+    void pop();
+    //! Remove all items.
+    void clear() noexcept;
+};
+
+/**
+ * @brief Sliding-window aggregation over a time window.
+ *
+ * @details swag whose items have a timestamp (non-decreasing), with
+ *          evict_older_than() removing the items that fell out of the
+ *          time window.
+ *
+ * @tparam T Aggregate type.
+ * @tparam Op Associative binary operator.
+ * @tparam Time Timestamp type.
+ * @tparam Allocator Allocator.
+ */
+template<std::copyable T, typename Op, std::totally_ordered Time = std::chrono::steady_clock::time_point, typename Allocator = std::allocator<T>>
+  requires std::regular_invocable<Op &, const T &, const T &>
+class timed_swag
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using time_type = Time;
+
+  private: // declarations
+
+    using time_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Time>;
+
+  private: // members
+
+    //! Window items.
+    swag<T, Op, Allocator> mSwag;
+    //! Items timestamps.
+    cqueue<Time, time_allocator> mTimes;
+
+  public: // methods
+
+    //! Constructor.
+    explicit timed_swag(const T &identity, const Op &op = Op(), const Allocator &alloc = Allocator()) :
+      mSwag(identity, op, alloc), mTimes(0, time_allocator(alloc)) {}
+
+    //! Return the number of items in the window.
+    size_type size() const noexcept { return mSwag.size(); }
+    //! Check if window is empty.
+    [[nodiscard]] bool empty() const noexcept { return mSwag.empty(); }
+    //! Aggregate of the window items (identity if empty).
+    T query() const { return mSwag.query(); }
+    //! Timestamp of the oldest item.
+    const Time & oldest() const { return mTimes.front(); }
+    //! Timestamp of the newest item.
+    const Time & newest() const { return mTimes.back(); }
+    //! Insert an item.
+    void push(const Time &time, const T &val);
+    //! Evict items with timestamp before time (returns number of evicted items).
+    size_type evict_older_than(const Time &time);
+    //! Remove all items.
+    void clear() noexcept { mSwag.clear(); mTimes.clear(); }
+};
+
+} // namespace gto
+
+/**
+ * @return Suffix aggregate of the first item, or identity if no front items.
+ */
+template<std::copyable T, typename Op, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+auto gto::swag<T, Op, Allocator>::getAggFront() const -> const T & {
+  return (mFront > 0 ? mQueue.front().agg : mIdentity);
+}
+
+/**
+ * @details Rebuild computes the middle suffix aggregates from its last
+ *          item. Merge appends the middle aggregate to the front suffix
+ *          aggregates from the first item (the next ones to be popped).
+ */
+template<std::copyable T, typename Op, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+void gto::swag<T, Op, Allocator>::step() {
+  if (mPhase == phase::rebuild) {
+    size_type pos = mFront + mCursor - 1;
+    entry &item = mQueue[pos];
+    item.agg = (mCursor == mMiddle ? item.val : mOp(item.val, mQueue[pos + 1].agg));
+    if (--mCursor == 0) {
+      mPhase = phase::merge;
+    }
+  }
+  else if (mPhase == phase::merge) {
+    if (mCursor < mFront) {
+      entry &item = mQueue[mCursor];
+      item.agg = mOp(item.agg, mAggMiddle);
+      ++mCursor;
+    }
+    if (mCursor == mFront) {
+      mFront += mMiddle;
+      mMiddle = 0;
+      mCursor = 0;
+      mAggMiddle = mIdentity;
+      mPhase = phase::idle;
+    }
+  }
+}
+
+/**
+ * @details The back is frozen as middle when it is as long as the front.
+ *          Rebuild (middle length steps) and merge (front length steps)
+ *          at 2 steps per operation end before the front is popped out,
+ *          and before the new back outgrows the new front.
+ */
+template<std::copyable T, typename Op, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+void gto::swag<T, Op, Allocator>::fixup() {
+  size_type lenBack = mQueue.size() - mFront - mMiddle;
+  if (mPhase == phase::idle && lenBack > 0 && lenBack >= mFront) {
+    mMiddle = lenBack;
+    mCursor = lenBack;
+    mAggMiddle = std::move(mAggBack);
+    mAggBack = mIdentity;
+    mPhase = phase::rebuild;
+  }
+  step();
+  step();
+}
+
+/**
+ * @return op(front, op(middle, back)) aggregate.
+ */
+template<std::copyable T, typename Op, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+T gto::swag<T, Op, Allocator>::query() const {
+  if (mPhase == phase::idle || (mPhase == phase::merge && mCursor > 0)) {
+    // front aggregates include middle
+    return mOp(getAggFront(), mAggBack);
+  }
+  return mOp(mOp(getAggFront(), mAggMiddle), mAggBack);
+}
+
+/**
+ * @param[in] val Value to add.
+ * @exception std::length_error Number of values exceed queue capacity.
+ * @exception ... Error throwed by op or copy constructor.
+ */
+template<std::copyable T, typename Op, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+void gto::swag<T, Op, Allocator>::push(const T &val) {
+  T agg = mOp(mAggBack, val);
+  mQueue.push_back(entry{val, val});
+  mAggBack = std::move(agg);
+  fixup();
+}
+
+/**
+ * @exception std::out_of_range Empty window.
+ */
+template<std::copyable T, typename Op, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+void gto::swag<T, Op, Allocator>::pop() {
+  if (mQueue.empty()) {
+    CQUEUE_THROW(std::out_of_range("swag empty"));
+  }
+  // flip ends before the front is empty (see fixup)
+  assert(mFront > 0 || mPhase == phase::idle);
+  mQueue.pop_front();
+  --mFront;
+  if (mPhase == phase::merge && mCursor > 0) {
+    --mCursor;
+  }
+  fixup();
+}
+
+template<std::copyable T, typename Op, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+void gto::swag<T, Op, Allocator>::clear() noexcept {
+  mQueue.clear();
+  mFront = 0;
+  mMiddle = 0;
+  mCursor = 0;
+  mAggMiddle = mIdentity;
+  mAggBack = mIdentity;
+  mPhase = phase::idle;
+}
+
+/**
+ * @param[in] time Item timestamp (not before newest).
+ * @param[in] val Value to add.
+ * @exception std::invalid_argument Timestamp before newest item.
+ * @exception ... Error throwed by op or copy constructor.
+ */
+template<std::copyable T, typename Op, std::totally_ordered Time, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+void gto::timed_swag<T, Op, Time, Allocator>::push(const Time &time, const T &val) {
+  if (!mTimes.empty() && time < mTimes.back()) {
+    CQUEUE_THROW(std::invalid_argument("timed_swag timestamp out of order"));
+  }
+  mTimes.push_back(time);
+  CQUEUE_TRY {
+    mSwag.push(val);
+  } CQUEUE_CATCH_ALL {
+    mTimes.pop_back();
+    CQUEUE_RETHROW;
+  }
+}
+
+/**
+ * @param[in] time Window start (items with this timestamp are kept).
+ * @return Number of evicted items.
+ */
+template<std::copyable T, typename Op, std::totally_ordered Time, typename Allocator>
+  requires std::regular_invocable<Op &, const T &, const T &>
+auto gto::timed_swag<T, Op, Time, Allocator>::evict_older_than(const Time &time) -> size_type {
+  size_type ret = 0;
+  while (!mTimes.empty() && mTimes.front() < time) {
+    mSwag.pop();
+    mTimes.pop_front();
+    ++ret;
+  }
+  return ret;
+}
@@ -0,0 +1,130 @@
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include "catch.hpp"
+#include "syncqueue.hpp"
+
+using gto::cqueue;
+using gto::syncqueue;
+using gto::eventfd_notifier;
+
+namespace {
+
+struct counting_notifier {
+  int count = 0;
+  void notify() noexcept { count++; }
+};
+
+} // unnamed namespace
+
+TEST_CASE("syncqueue") {
+
+  SECTION("default constructor") {
+    syncqueue<int> queue;
+    CHECK(queue.size() == 0);
+    CHECK(queue.empty());
+    CHECK(queue.capacity() == 0);
+    CHECK(!queue.try_pop().has_value());
+  }
+
+  SECTION("push-pop") {
+    syncqueue<int> queue(2);
+    CHECK(queue.try_push(1));
+    queue.push(2);
+    CHECK(!queue.try_push(3));
+    CHECK_THROWS_AS(queue.push(3), std::length_error);
+    CHECK(queue.size() == 2);
+    CHECK(queue.try_pop() == 1);
+    cqueue<int> items;
+    CHECK(queue.pop_all(items) == 1);
+    CHECK(items.size() == 1);
+    CHECK(items.front() == 2);
+    CHECK(queue.empty());
+  }
+
+  SECTION("coalesced notifications") {
+    syncqueue<int, counting_notifier> queue;
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    CHECK(queue.notifier().count == 1);
+    queue.try_pop();
+    queue.push(4);
+    CHECK(queue.notifier().count == 1);
+    cqueue<int> items;
+    queue.pop_all(items);
+    queue.push(5);
+    CHECK(queue.notifier().count == 2);
+  }
+
+  SECTION("eventfd") {
+    syncqueue<int, eventfd_notifier> queue;
+    int fd = queue.notifier().fd();
+    CHECK(fd >= 0);
+    CHECK(queue.notifier().reset() == 0);
+    queue.push(1);
+    queue.push(2);
+    CHECK(queue.notifier().reset() == 1);
+    CHECK(queue.notifier().reset() == 0);
+    // move keeps the fd
+    eventfd_notifier notifier = std::move(queue.notifier());
+    CHECK(notifier.fd() == fd);
+    CHECK(queue.notifier().fd() == -1);
+  }
+
+  SECTION("epoll") {
+    constexpr int NUM_PRODUCERS = 4;
+    constexpr int NUM_ITEMS = 50'000;
+    syncqueue<std::uint64_t, eventfd_notifier> queue;
+
+    int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    REQUIRE(epfd >= 0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = queue.notifier().fd();
+    REQUIRE(::epoll_ctl(epfd, EPOLL_CTL_ADD, queue.notifier().fd(), &ev) == 0);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < NUM_PRODUCERS; p++) {
+      producers.emplace_back([&queue, p]() {
+        for (int i = 0; i < NUM_ITEMS; i++) {
+          queue.push(static_cast<std::uint64_t>(p * NUM_ITEMS + i));
+        }
+      });
+    }
+
+    // reactor loop
+    cqueue<std::uint64_t> items;
+    std::vector<bool> seen(NUM_PRODUCERS * NUM_ITEMS, false);
+    std::size_t count = 0;
+    std::size_t wakeups = 0;
+    bool ok = true;
+    while (count < seen.size()) {
+      epoll_event events[4];
+      int n = ::epoll_wait(epfd, events, 4, 5000);
+      REQUIRE(n == 1);
+      CHECK(events[0].data.fd == queue.notifier().fd());
+      wakeups++;
+      queue.notifier().reset();
+      queue.pop_all(items);
+      items.drain([&](std::uint64_t val) {
+        ok = ok && val < seen.size() && !seen[val];
+        if (val < seen.size()) seen[val] = true;
+        count++;
+      });
+    }
+
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    ::close(epfd);
+
+    CHECK(ok);
+    CHECK(count == seen.size());
+    CHECK(wakeups <= seen.size());
+    CHECK(queue.empty());
+  }
+
+}
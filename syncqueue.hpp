@@ -0,0 +1,153 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <optional>
+#include "cqueue.hpp"
+#include "notifier.hpp"
+
+namespace gto {
+
+/**
+ * @brief Thread-safe cqueue guarded by a mutex.
+ *
+ * @details Producers push items from any thread. The notifier is called
+ *          only when a push makes the queue non-empty, so bursts of pushes
+ *          produce a single wakeup. With eventfd_notifier a reactor thread
+ *          can wait for items in epoll_wait():
+ *
+ *            epoll_ctl(epfd, EPOLL_CTL_ADD, queue.notifier().fd(), &ev);
+ *            ...
+ *            queue.notifier().reset();   // before draining
+ *            queue.pop_all(items);
+ *
+ *          Notification is done after releasing the lock, so a consumer
+ *          can see a spurious wakeup (queue already drained), but never
+ *          misses one.
+ *
+ * @tparam T Elements type.
+ * @tparam Notifier Notifier policy (nonotifier or eventfd_notifier).
+ * @tparam Allocator Allocator.
+ */
+template<std::movable T, typename Notifier = nonotifier, typename Allocator = std::allocator<T>>
+class syncqueue
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using queue_type = cqueue<T, Allocator>;
+    using notifier_type = Notifier;
+
+  private: // members
+
+    //! Mutex guarding the queue.
+    mutable std::mutex mMutex{};
+    //! Queued items.
+    queue_type mQueue;
+    //! Empty to non-empty notifier.
+    [[no_unique_address]] Notifier mNotifier;
+
+  public: // methods
+
+    //! Constructor (capacity=0 means unlimited).
+    explicit syncqueue(size_type capacity = 0, Notifier notifier = Notifier(), const Allocator &alloc = Allocator()) :
+      mQueue(capacity, alloc), mNotifier(std::move(notifier)) {}
+
+    //! Return the notifier.
+    Notifier & notifier() noexcept { return mNotifier; }
+    //! Return queue capacity.
+    size_type capacity() const noexcept { return mQueue.capacity(); }
+    //! Return the number of items.
+    size_type size() const { std::lock_guard lock(mMutex); return mQueue.size(); }
+    //! Check if there are items in the queue.
+    [[nodiscard]] bool empty() const { std::lock_guard lock(mMutex); return mQueue.empty(); }
+
+    //! Construct and insert an element at the end (false if full).
+    template <class... Args>
+    bool try_emplace(Args&&... args);
+    //! Insert an element at the end (false if full).
+    bool try_push(const T &val) { return try_emplace(val); }
+    //! Insert an element at the end (false if full).
+    bool try_push(T &&val) { return try_emplace(std::move(val)); }
+    //! Insert an element at the end.
+    void push(const T &val);
+    //! Insert an element at the end.
+    void push(T &&val);
+
+    //! Remove the front element (nullopt if empty).
+    std::optional<T> try_pop();
+    //! Move all elements to the back of dest.
+    size_type pop_all(queue_type &dest);
+};
+
+} // namespace gto
+
+/**
+ * @param[in] args Arguments of the new element.
+ * @return true = inserted, false = queue full.
+ * @exception ... Error throwed by constructor or memory allocation.
+ */
+template<std::movable T, typename Notifier, typename Allocator>
+template <class... Args>
+bool gto::syncqueue<T, Notifier, Allocator>::try_emplace(Args&&... args) {
+  bool wasEmpty = false;
+  {
+    std::lock_guard lock(mMutex);
+    wasEmpty = mQueue.empty();
+    if (mQueue.try_emplace_back(std::forward<Args>(args)...) == nullptr) {
+      return false;
+    }
+  }
+  if (wasEmpty) {
+    mNotifier.notify();
+  }
+  return true;
+}
+
+/**
+ * @param[in] val Value to add.
+ * @exception std::length_error Number of values exceed queue capacity.
+ * @exception ... Error throwed by copy constructor or memory allocation.
+ */
+template<std::movable T, typename Notifier, typename Allocator>
+void gto::syncqueue<T, Notifier, Allocator>::push(const T &val) {
+  if (!try_emplace(val)) {
+    CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
+  }
+}
+
+/**
+ * @param[in] val Value to add.
+ * @exception std::length_error Number of values exceed queue capacity.
+ * @exception ... Error throwed by move constructor or memory allocation.
+ */
+template<std::movable T, typename Notifier, typename Allocator>
+void gto::syncqueue<T, Notifier, Allocator>::push(T &&val) {
+  if (!try_emplace(std::move(val))) {
+    CQUEUE_THROW(std::length_error("cqueue capacity exceeded"));
+  }
+}
+
+/**
+ * @return Removed element, or nullopt if there are no elements in the queue.
+ */
+template<std::movable T, typename Notifier, typename Allocator>
+auto gto::syncqueue<T, Notifier, Allocator>::try_pop() -> std::optional<T> {
+  std::lock_guard lock(mMutex);
+  return mQueue.try_pop_front();
+}
+
+/**
+ * @details Elements are moved in a single locked step (the buffer is
+ *          handed over when dest is empty, see cqueue::transfer_front()).
+ * @param[in] dest Destination queue.
+ * @return Number of moved elements.
+ * @exception ... Error throwed by move contructors or memory allocation.
+ */
+template<std::movable T, typename Notifier, typename Allocator>
+auto gto::syncqueue<T, Notifier, Allocator>::pop_all(queue_type &dest) -> size_type {
+  std::lock_guard lock(mMutex);
+  return dest.splice_back(mQueue);
+}
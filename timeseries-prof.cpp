@@ -0,0 +1,79 @@
+#include "timeseries.hpp"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+
+#define DEFAULT_NUM_QUERIES 5000000
+#define NUM_ITEMS 1000000
+
+// g++ -std=c++20 -O3 -o timeseries-prof timeseries-prof.cpp
+// ./timeseries-prof [num-queries]
+// Window queries [t0, t1) over a wrapped ring of 1M (timestamp, value)
+// items, using timeseries::range() (segment-aware search) and
+// std::lower_bound through cqueue iterators (baseline).
+
+using namespace gto;
+
+template<typename Fn>
+void measure(const char *name, std::size_t n, Fn fn) {
+  auto t1 = std::chrono::steady_clock::now();
+  std::size_t checksum = fn();
+  auto t2 = std::chrono::steady_clock::now();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+  std::cout
+      << name << " elapsed time in microseconds : " << us << " µs ("
+      << (n > 0 ? static_cast<double>(us) * 1000.0 / static_cast<double>(n) : 0.0) << " ns/query, "
+      << "checksum " << checksum << ")\n";
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t n = (argc > 1 ? std::stoul(argv[1]) : DEFAULT_NUM_QUERIES);
+
+  // same content in both containers, wrapped buffer
+  timeseries<double> series(NUM_ITEMS);
+  cqueue<std::pair<std::int64_t, double>> queue(NUM_ITEMS);
+  std::int64_t now = 0;
+  for (std::size_t i = 0; i < NUM_ITEMS + NUM_ITEMS / 3; i++) {
+    now += 1 + static_cast<std::int64_t>(i % 3);
+    if (series.full()) {
+      series.evict_older_than(series.front().first + 1);
+      queue.pop_front();
+    }
+    series.push(now, static_cast<double>(i));
+    queue.push_back({now, static_cast<double>(i)});
+  }
+
+  std::mt19937_64 rng(1);
+  std::int64_t first = series.front().first;
+  std::int64_t span = series.back().first - first;
+  std::vector<std::pair<std::int64_t, std::int64_t>> windows(n);
+  for (auto &[t0, t1] : windows) {
+    t0 = first + static_cast<std::int64_t>(rng() % static_cast<std::uint64_t>(span));
+    t1 = t0 + static_cast<std::int64_t>(rng() % 1000);
+  }
+
+  measure("timeseries::range", n, [&]() {
+    std::size_t sum = 0;
+    for (const auto &[t0, t1] : windows) {
+      auto [seg1, seg2] = series.range(t0, t1);
+      sum += seg1.size() + seg2.size();
+    }
+    return sum;
+  });
+
+  measure("std::lower_bound (iterators)", n, [&]() {
+    std::size_t sum = 0;
+    auto before = [](const std::pair<std::int64_t, double> &item, std::int64_t t) { return item.first < t; };
+    for (const auto &[t0, t1] : windows) {
+      auto it0 = std::lower_bound(queue.begin(), queue.end(), t0, before);
+      auto it1 = std::lower_bound(it0, queue.end(), t1, before);
+      sum += static_cast<std::size_t>(it1 - it0);
+    }
+    return sum;
+  });
+}
@@ -0,0 +1,104 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include "catch.hpp"
+#include "timeseries.hpp"
+
+using gto::timeseries;
+
+namespace {
+
+// items of a range as a vector
+template<typename Segments>
+std::vector<std::int64_t> times_of(const Segments &segs) {
+  std::vector<std::int64_t> ret;
+  for (const auto &item : segs.first) ret.push_back(item.first);
+  for (const auto &item : segs.second) ret.push_back(item.first);
+  return ret;
+}
+
+} // unnamed namespace
+
+TEST_CASE("timeseries") {
+
+  SECTION("basic") {
+    timeseries<std::string> series;
+    CHECK(series.empty());
+    CHECK(series.lower_bound(10) == 0);
+    CHECK(series.count(0, 100) == 0);
+    CHECK(series.evict_older_than(100) == 0);
+    series.push(10, "a");
+    series.push(20, "b");
+    series.emplace(20, 2, 'c');
+    series.push(40, "d");
+    CHECK_THROWS_AS(series.push(30, "x"), std::invalid_argument);
+    CHECK(series.size() == 4);
+    CHECK(series.front().second == "a");
+    CHECK(series.back().first == 40);
+    CHECK(series[2].second == "cc");
+    CHECK(series.lower_bound(0) == 0);
+    CHECK(series.lower_bound(10) == 0);
+    CHECK(series.lower_bound(11) == 1);
+    CHECK(series.lower_bound(20) == 1);
+    CHECK(series.lower_bound(21) == 3);
+    CHECK(series.lower_bound(41) == 4);
+    CHECK(times_of(series.range(20, 40)) == std::vector<std::int64_t>{20, 20});
+    CHECK(times_of(series.range(0, 100)) == std::vector<std::int64_t>{10, 20, 20, 40});
+    CHECK(times_of(series.range(40, 20)).empty());
+    CHECK(series.count(11, 41) == 3);
+    CHECK(series.evict_older_than(20) == 1);
+    CHECK(series.front().first == 20);
+    CHECK(series.evict_older_than(20) == 0);
+    CHECK(series.evict_older_than(100) == 3);
+    CHECK(series.empty());
+  }
+
+  SECTION("wrapped") {
+    timeseries<int> series(16);
+    // buffer wraps after evictions
+    for (std::int64_t t = 0; t < 100; t++) {
+      if (series.full()) {
+        CHECK(series.evict_older_than(series.front().first + 5) == 5);
+      }
+      series.push(t, static_cast<int>(t));
+      for (std::int64_t t0 = series.front().first - 1; t0 <= t + 1; t0++) {
+        auto pos = series.lower_bound(t0);
+        REQUIRE(pos <= series.size());
+        if (pos < series.size()) REQUIRE(series[pos].first >= t0);
+        if (pos > 0) REQUIRE(series[pos - 1].first < t0);
+      }
+    }
+    auto segs = series.range(series.front().first + 1, series.back().first);
+    CHECK(!segs.second.empty());
+    CHECK(segs.first.size() + segs.second.size() == series.size() - 2);
+  }
+
+  SECTION("random") {
+    std::mt19937 rng(11);
+    timeseries<int> series(64);
+    std::vector<std::int64_t> all;
+    std::int64_t now = 0;
+    for (int i = 0; i < 5000; i++) {
+      now += static_cast<std::int64_t>(rng() % 3);
+      if (series.full()) {
+        std::int64_t limit = series.front().first + static_cast<std::int64_t>(rng() % 10) + 1;
+        series.evict_older_than(limit);
+        std::erase_if(all, [limit](std::int64_t t) { return t < limit; });
+      }
+      series.push(now, i);
+      all.push_back(now);
+      std::int64_t t0 = now - static_cast<std::int64_t>(rng() % 100);
+      std::int64_t t1 = t0 + static_cast<std::int64_t>(rng() % 50);
+      std::vector<std::int64_t> expected;
+      for (std::int64_t t : all) {
+        if (t0 <= t && t < t1) expected.push_back(t);
+      }
+      REQUIRE(times_of(series.range(t0, t1)) == expected);
+      REQUIRE(series.count(t0, t1) == expected.size());
+    }
+  }
+
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <tuple>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <concepts>
+#include <algorithm>
+#include <stdexcept>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Ring of (timestamp, value) items ordered by timestamp.
+ *
+ * @details Items are pushed with non-decreasing timestamps, so the ring
+ *          is sorted and window queries are binary searches. Searches are
+ *          segment-aware: the ring content is at most two contiguous
+ *          arrays, the one containing the timestamp is chosen comparing
+ *          with the first item of the second one, and it is searched with
+ *          raw pointers (no checked index nor modulo per probe).
+ *          range() returns the matching items in place as (at most two)
+ *          spans, and evict_older_than() removes the expired items with a
+ *          single bulk pop.
+ *
+ * @note This class is not thread-safe (like cqueue).
+ *
+ * @tparam T Values type.
+ * @tparam Time Timestamp type.
+ * @tparam Allocator Allocator.
+ */
+template<std::movable T, std::totally_ordered Time = std::int64_t, typename Allocator = std::allocator<std::pair<Time, T>>>
+class timeseries
+{
+  public: // declarations
+
+    using value_type = std::pair<Time, T>;
+    using size_type = std::size_t;
+    using time_type = Time;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using const_iterator = typename cqueue<value_type, Allocator>::const_iterator;
+    using const_segments = typename cqueue<value_type, Allocator>::const_segments;
+
+  private: // members
+
+    //! Items (sorted by timestamp).
+    cqueue<value_type, Allocator> mQueue;
+
+  private: // static methods
+
+    //! Compare item timestamp with a time.
+    static bool isBefore(const value_type &item, const Time &time) { return item.first < time; }
+
+  private: // methods
+
+    //! Position of the first item from pos with timestamp not before time.
+    size_type getLowerBound(const Time &time, size_type pos) const;
+
+  public: // methods
+
+    //! Constructor (capacity=0 means unlimited).
+    explicit timeseries(size_type capacity = 0, const Allocator &alloc = Allocator()) : mQueue(capacity, alloc) {}
+
+    //! Return ring capacity.
+    size_type capacity() const noexcept { return mQueue.capacity(); }
+    //! Return the number of items.
+    size_type size() const noexcept { return mQueue.size(); }
+    //! Check if there are items.
+    [[nodiscard]] bool empty() const noexcept { return mQueue.empty(); }
+    //! Check if ring is full.
+    bool full() const noexcept { return mQueue.full(); }
+    //! Access the oldest item.
+    const_reference front() const { return mQueue.front(); }
+    //! Access the newest item.
+    const_reference back() const { return mQueue.back(); }
+    //! Access item by position.
+    const_reference operator[](size_type n) const { return mQueue[n]; }
+    //! Return an iterator to the oldest item.
+    const_iterator begin() const noexcept { return mQueue.begin(); }
+    //! Return an iterator past the newest item.
+    const_iterator end() const noexcept { return mQueue.end(); }
+
+    //! Construct and insert an item (timestamp not before newest).
+    template <class... Args>
+    reference emplace(const Time &time, Args&&... args);
+    //! Insert an item (timestamp not before newest).
+    reference push(const Time &time, const T &val) { return emplace(time, val); }
+    //! Insert an item (timestamp not before newest).
+    reference push(const Time &time, T &&val) { return emplace(time, std::move(val)); }
+
+    //! Position of the first item with timestamp not before time.
+    size_type lower_bound(const Time &time) const { return getLowerBound(time, 0); }
+    //! Items with timestamp in [t0, t1).
+    const_segments range(const Time &t0, const Time &t1) const;
+    //! Number of items with timestamp in [t0, t1).
+    size_type count(const Time &t0, const Time &t1) const;
+    //! Remove items with timestamp before time (returns number of removed items).
+    size_type evict_older_than(const Time &time);
+    //! Remove all items.
+    void clear() noexcept { mQueue.clear(); }
+};
+
+} // namespace gto
+
+/**
+ * @param[in] time Item timestamp.
+ * @param[in] args Arguments of the new value.
+ * @return Reference to the inserted item.
+ * @exception std::invalid_argument Timestamp before newest item.
+ * @exception std::length_error Number of values exceed queue capacity.
+ */
+template<std::movable T, std::totally_ordered Time, typename Allocator>
+template <class... Args>
+auto gto::timeseries<T, Time, Allocator>::emplace(const Time &time, Args&&... args) -> reference {
+  if (!mQueue.empty() && time < mQueue.back().first) {
+    CQUEUE_THROW(std::invalid_argument("timeseries timestamp out of order"));
+  }
+  return mQueue.emplace_back(std::piecewise_construct, std::forward_as_tuple(time), std::forward_as_tuple(std::forward<Args>(args)...));
+}
+
+/**
+ * @details Binary search on the contiguous segment containing time.
+ * @param[in] time Timestamp.
+ * @param[in] pos Search start position (items before have timestamp before time).
+ * @return Position in [pos, size()].
+ */
+template<std::movable T, std::totally_ordered Time, typename Allocator>
+auto gto::timeseries<T, Time, Allocator>::getLowerBound(const Time &time, size_type pos) const -> size_type {
+  auto [seg1, seg2] = mQueue.spans(pos, mQueue.size() - pos);
+  if (seg2.empty() || !isBefore(seg2.front(), time)) {
+    return pos + static_cast<size_type>(std::lower_bound(seg1.begin(), seg1.end(), time, isBefore) - seg1.begin());
+  }
+  return pos + seg1.size() + static_cast<size_type>(std::lower_bound(seg2.begin(), seg2.end(), time, isBefore) - seg2.begin());
+}
+
+/**
+ * @param[in] t0 Window start (included).
+ * @param[in] t1 Window end (excluded).
+ * @return Matching items in place (empty if t1 <= t0).
+ */
+template<std::movable T, std::totally_ordered Time, typename Allocator>
+auto gto::timeseries<T, Time, Allocator>::range(const Time &t0, const Time &t1) const -> const_segments {
+  if (!(t0 < t1)) {
+    return {};
+  }
+  size_type pos0 = getLowerBound(t0, 0);
+  size_type pos1 = getLowerBound(t1, pos0);
+  return mQueue.spans(pos0, pos1 - pos0);
+}
+
+/**
+ * @param[in] t0 Window start (included).
+ * @param[in] t1 Window end (excluded).
+ * @return Number of items in the window.
+ */
+template<std::movable T, std::totally_ordered Time, typename Allocator>
+auto gto::timeseries<T, Time, Allocator>::count(const Time &t0, const Time &t1) const -> size_type {
+  if (!(t0 < t1)) {
+    return 0;
+  }
+  size_type pos0 = getLowerBound(t0, 0);
+  return getLowerBound(t1, pos0) - pos0;
+}
+
+/**
+ * @param[in] time Window start (items with this timestamp are kept).
+ * @return Number of removed items.
+ */
+template<std::movable T, std::totally_ordered Time, typename Allocator>
+auto gto::timeseries<T, Time, Allocator>::evict_older_than(const Time &time) -> size_type {
+  return mQueue.consume_front(lower_bound(time), [](value_type &) {});
+}
@@ -0,0 +1,56 @@
+#include "walqueue.hpp"
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+
+#define DEFAULT_NUM_ITEMS 20000
+#define WALQUEUE_PATH "/tmp/walqueue-prof"
+
+// g++ -std=c++20 -O3 -pthread -o walqueue-prof walqueue-prof.cpp
+// ./walqueue-prof [num-items]
+// Durable pushes from 1 to 16 concurrent producers. Group commit shares
+// each fdatasync among the producers waiting for it (pushes/sync > 1).
+
+using namespace gto;
+
+int main(int argc, char *argv[]) {
+  std::size_t num_items = (argc > 1 ? std::stoul(argv[1]) : DEFAULT_NUM_ITEMS);
+
+  for (std::size_t num_threads : std::array<std::size_t, 5>{1, 2, 4, 8, 16}) {
+    std::remove(WALQUEUE_PATH ".log");
+    std::remove(WALQUEUE_PATH ".ckpt");
+    walqueue<std::uint64_t> queue(WALQUEUE_PATH);
+    std::size_t per_thread = num_items / num_threads;
+
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (std::size_t t = 0; t < num_threads; t++) {
+      producers.emplace_back([&queue, per_thread]() {
+        for (std::uint64_t i = 0; i < per_thread; i++) {
+          queue.push(i);
+        }
+      });
+    }
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+    std::size_t total = per_thread * num_threads;
+
+    std::cout
+        << "threads=" << num_threads
+        << " elapsed time in microseconds : " << us << " µs ("
+        << (us > 0 ? static_cast<double>(total) * 1e6 / static_cast<double>(us) : 0.0) << " pushes/s, "
+        << static_cast<double>(total) / static_cast<double>(queue.syncs()) << " pushes/sync)\n";
+  }
+
+  std::remove(WALQUEUE_PATH ".log");
+  std::remove(WALQUEUE_PATH ".ckpt");
+}
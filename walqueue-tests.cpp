@@ -0,0 +1,347 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <filesystem>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <csignal>
+#include "catch.hpp"
+#include "walqueue.hpp"
+
+using gto::walqueue;
+using gto::walqueue_policy;
+
+namespace {
+
+std::string temp_path(const char *name) {
+  std::string path = "/tmp/cqueue-tests-" + std::to_string(::getpid()) + "-" + name;
+  std::remove((path + ".log").c_str());
+  std::remove((path + ".ckpt").c_str());
+  return path;
+}
+
+void remove_files(const std::string &path) {
+  std::remove((path + ".log").c_str());
+  std::remove((path + ".ckpt").c_str());
+}
+
+std::string read_file(const std::string &path) {
+  std::ifstream is(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+}
+
+void write_file(const std::string &path, const std::string &data) {
+  std::ofstream os(path, std::ios::binary | std::ios::trunc);
+  os.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+} // unnamed namespace
+
+TEST_CASE("walqueue") {
+
+  SECTION("recovery") {
+    std::string path = temp_path("wal-recovery");
+    {
+      walqueue<int> queue(path);
+      CHECK(queue.empty());
+      CHECK(queue.log_size() == 16);
+      CHECK(!queue.try_pop().has_value());
+      for (int i = 1; i <= 5; i++) queue.push(i);
+      CHECK(queue.size() == 5);
+      CHECK(queue.syncs() == 5);
+      CHECK(queue.try_pop() == 1);
+      CHECK(queue.try_pop() == 2);
+    }
+    {
+      walqueue<int> queue(path);
+      CHECK(queue.size() == 3);
+      CHECK(queue.try_pop() == 3);
+      CHECK(queue.try_pop() == 4);
+      CHECK(queue.try_pop() == 5);
+    }
+    remove_files(path);
+  }
+
+  SECTION("checkpoint") {
+    std::string path = temp_path("wal-checkpoint");
+    {
+      walqueue<int> queue(path);
+      for (int i = 1; i <= 5; i++) queue.push(i);
+      queue.try_pop();
+      CHECK(queue.log_size() > 16);
+      queue.checkpoint();
+      CHECK(queue.log_size() == 16);
+      CHECK(queue.size() == 4);
+      queue.push(6);
+      queue.try_pop();
+    }
+    {
+      walqueue<int> queue(path);
+      CHECK(queue.size() == 4);
+      CHECK(queue.try_pop() == 3);
+      queue.checkpoint();
+    }
+    {
+      walqueue<int> queue(path);
+      CHECK(queue.size() == 3);
+      CHECK(queue.try_pop() == 4);
+    }
+    remove_files(path);
+  }
+
+  SECTION("automatic checkpoint") {
+    std::string path = temp_path("wal-auto");
+    walqueue_policy policy{200, 0};
+    {
+      walqueue<int> queue(path, policy);
+      for (int i = 0; i < 100; i++) {
+        queue.push(i);
+        CHECK(queue.log_size() <= 200);
+      }
+      for (int i = 0; i < 50; i++) queue.try_pop();
+      CHECK(queue.log_size() <= 200);
+    }
+    {
+      walqueue<int> queue(path, policy);
+      CHECK(queue.size() == 50);
+      CHECK(queue.try_pop() == 50);
+    }
+    remove_files(path);
+  }
+
+  SECTION("truncate when empty") {
+    std::string path = temp_path("wal-truncate");
+    walqueue_policy policy{0, 0};
+    {
+      walqueue<int> queue(path, policy);
+      for (int i = 0; i < 3; i++) queue.push(i);
+      queue.try_pop();
+      queue.try_pop();
+      CHECK(queue.log_size() > 16);
+      queue.try_pop();
+      CHECK(queue.log_size() == 16);
+      queue.push(7);
+    }
+    {
+      walqueue<int> queue(path, policy);
+      CHECK(queue.size() == 1);
+      CHECK(queue.try_pop() == 7);
+    }
+    remove_files(path);
+  }
+
+  SECTION("torn record") {
+    std::string path = temp_path("wal-torn");
+    {
+      walqueue<std::uint64_t> queue(path);
+      for (std::uint64_t i = 0; i < 3; i++) queue.push(i);
+    }
+    std::string log = read_file(path + ".log");
+    REQUIRE(log.size() == 16 + 3 * 16);
+    // partial record
+    write_file(path + ".log", log + std::string(10, 'x'));
+    {
+      walqueue<std::uint64_t> queue(path);
+      CHECK(queue.size() == 3);
+      CHECK(queue.log_size() == log.size());
+      queue.push(3);
+    }
+    // corrupted last record
+    log = read_file(path + ".log");
+    log[log.size() - 1] ^= 1;
+    write_file(path + ".log", log);
+    {
+      walqueue<std::uint64_t> queue(path);
+      CHECK(queue.size() == 3);
+      CHECK(queue.try_pop() == 0);
+    }
+    remove_files(path);
+  }
+
+  SECTION("write error") {
+    std::string path = temp_path("wal-write-error");
+    pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      // child: file size limit makes the 4th record a partial write (EFBIG)
+      int ret = 0;
+      ::signal(SIGXFSZ, SIG_IGN);
+      walqueue<std::uint64_t> queue(path);
+      for (std::uint64_t i = 0; i < 3; i++) queue.push(i);
+      rlimit limit{};
+      ::getrlimit(RLIMIT_FSIZE, &limit);
+      rlimit small = limit;
+      small.rlim_cur = 16 + 3 * 16 + 10;
+      ::setrlimit(RLIMIT_FSIZE, &small);
+      try {
+        queue.push(3);
+        ret = 1;
+      }
+      catch (const std::system_error &) {
+        // partial record removed
+      }
+      ::setrlimit(RLIMIT_FSIZE, &limit);
+      queue.push(4);
+      ret = (ret == 0 && queue.size() == 4 ? 0 : 2);
+      // crash (no destructor)
+      ::_exit(ret);
+    }
+    int status = -1;
+    ::waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+    {
+      walqueue<std::uint64_t> queue(path);
+      REQUIRE(queue.size() == 4);
+      CHECK(queue.try_pop() == 0);
+      CHECK(queue.try_pop() == 1);
+      CHECK(queue.try_pop() == 2);
+      CHECK(queue.try_pop() == 4);
+    }
+    remove_files(path);
+  }
+
+  SECTION("sync error") {
+    std::string path = temp_path("wal-sync-error");
+    {
+      walqueue<std::uint64_t> queue(path);
+      queue.push(0);
+      queue.push(1);
+      // replace the log by /dev/null (fdatasync fails with EINVAL)
+      int logFd = -1;
+      for (const auto &entry : std::filesystem::directory_iterator("/proc/self/fd")) {
+        std::error_code ec;
+        if (std::filesystem::read_symlink(entry.path(), ec) == path + ".log") {
+          logFd = std::stoi(entry.path().filename().string());
+        }
+      }
+      REQUIRE(logFd >= 0);
+      int nullFd = ::open("/dev/null", O_WRONLY);
+      REQUIRE(nullFd >= 0);
+      REQUIRE(::dup2(nullFd, logFd) == logFd);
+      ::close(nullFd);
+      // every producer waiting for the failed sync throws
+      constexpr int NUM_THREADS = 8;
+      std::atomic<int> errors{0};
+      std::vector<std::thread> producers;
+      for (int t = 0; t < NUM_THREADS; t++) {
+        producers.emplace_back([&queue, &errors, t]() {
+          try {
+            queue.push(static_cast<std::uint64_t>(10 + t));
+          }
+          catch (const std::system_error &) {
+            errors++;
+          }
+        });
+      }
+      for (auto &producer : producers) {
+        producer.join();
+      }
+      CHECK(errors == NUM_THREADS);
+      // writes rejected until reopened
+      CHECK_THROWS_AS(queue.push(2), std::system_error);
+      CHECK_THROWS_AS(queue.try_pop(), std::system_error);
+      CHECK_THROWS_AS(queue.checkpoint(), std::system_error);
+    }
+    {
+      walqueue<std::uint64_t> queue(path);
+      REQUIRE(queue.size() == 2);
+      CHECK(queue.try_pop() == 0);
+      CHECK(queue.try_pop() == 1);
+    }
+    remove_files(path);
+  }
+
+  SECTION("stale log") {
+    std::string path = temp_path("wal-stale");
+    std::string log;
+    {
+      walqueue<int> queue(path);
+      queue.push(1);
+      queue.push(2);
+      log = read_file(path + ".log");
+      queue.checkpoint();
+    }
+    // crash after checkpoint rename, before log reset
+    write_file(path + ".log", log);
+    {
+      walqueue<int> queue(path);
+      CHECK(queue.size() == 2);
+      CHECK(queue.log_size() == 16);
+    }
+    remove_files(path);
+  }
+
+  SECTION("incompatible checkpoint") {
+    std::string path = temp_path("wal-incompatible");
+    write_file(path + ".ckpt", std::string(64, 'x'));
+    CHECK_THROWS_AS(walqueue<int>(path), std::invalid_argument);
+    CHECK_THROWS_AS(walqueue<int>("/nonexistent/dir/queue"), std::system_error);
+    remove_files(path);
+  }
+
+  SECTION("group commit") {
+    constexpr std::uint64_t NUM_THREADS = 8;
+    constexpr std::uint64_t NUM_ITEMS = 500;
+    std::string path = temp_path("wal-group");
+    {
+      walqueue<std::uint64_t> queue(path);
+      std::vector<std::thread> producers;
+      for (std::uint64_t t = 0; t < NUM_THREADS; t++) {
+        producers.emplace_back([&queue, t]() {
+          for (std::uint64_t i = 0; i < NUM_ITEMS; i++) {
+            queue.push(t * NUM_ITEMS + i);
+          }
+        });
+      }
+      for (auto &producer : producers) {
+        producer.join();
+      }
+      CHECK(queue.size() == NUM_THREADS * NUM_ITEMS);
+      CHECK(queue.syncs() > 0);
+      CHECK(queue.syncs() <= NUM_THREADS * NUM_ITEMS);
+    }
+    {
+      walqueue<std::uint64_t> queue(path);
+      REQUIRE(queue.size() == NUM_THREADS * NUM_ITEMS);
+      // per-producer order is preserved
+      std::vector<std::uint64_t> next(NUM_THREADS, 0);
+      while (auto item = queue.try_pop()) {
+        std::uint64_t t = *item / NUM_ITEMS;
+        CHECK(*item % NUM_ITEMS == next[t]);
+        next[t]++;
+      }
+    }
+    remove_files(path);
+  }
+
+  SECTION("crash") {
+    std::string path = temp_path("wal-crash");
+    pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+      // child exits without running destructors
+      auto *queue = new walqueue<int>(path);
+      for (int i = 0; i < 10; i++) queue->push(i);
+      queue->try_pop();
+      ::_exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    REQUIRE(WIFEXITED(status));
+    {
+      walqueue<int> queue(path);
+      CHECK(queue.size() == 9);
+      CHECK(queue.try_pop() == 1);
+    }
+    remove_files(path);
+  }
+
+}
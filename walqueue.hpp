@@ -0,0 +1,552 @@
+#pragma once
+
+#include <mutex>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cqueue.hpp"
+#include "snapshot.hpp"
+
+namespace gto {
+
+/**
+ * @brief When walqueue compacts its log.
+ */
+struct walqueue_policy {
+  //! Checkpoint when the log exceeds this size (0 = disabled).
+  std::size_t checkpoint_bytes = 64 * 1024 * 1024;
+  //! Truncate the log when the queue becomes empty and the log exceeds this size.
+  std::size_t truncate_bytes = 1024 * 1024;
+};
+
+/**
+ * @brief Thread-safe durable queue journaled in a write-ahead log.
+ *
+ * @details State is kept in memory (a cqueue) and journaled in two files:
+ *          - path.log: append-only log of push and pop records.
+ *          - path.ckpt: checkpoint, a snapshot of the queue.
+ *          push() appends a record and returns once it is on disk. Syncs
+ *          are shared by concurrent producers (group commit): one of the
+ *          waiting producers calls fdatasync() covering all the records
+ *          appended so far while the others wait for it.
+ *          pop() appends a record that is not synced by itself (it is
+ *          synced with the next push or checkpoint), so a crash can
+ *          redeliver popped items (at-least-once).
+ *          checkpoint() saves the queue, atomically replaces the previous
+ *          checkpoint, and truncates the log. It is done automatically
+ *          when the log grows beyond a limit or when all items have been
+ *          popped (log truncation on acknowledgement).
+ *          Opening recovers the checkpoint and replays the log, ignoring a
+ *          torn record at its end. Checkpoint and log carry an epoch, so a
+ *          log older than the checkpoint (crash during checkpoint) is
+ *          discarded.
+ *          A failed fdatasync() is not retried (the kernel may have
+ *          dropped the dirty pages): every push waiting for it throws and
+ *          further writes are rejected until the queue is reopened.
+ *
+ * @note Items are visible to consumers once appended (before push returns).
+ *
+ * @tparam T Elements type (trivially copyable).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+class walqueue
+{
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+  private: // declarations
+
+    //! File identifier (log and checkpoint).
+    static constexpr std::uint64_t MAGIC = 0x65756575716c6177; // "walqueue"
+    //! Record type: item pushed.
+    static constexpr std::uint32_t RECORD_PUSH = 1;
+    //! Record type: items popped.
+    static constexpr std::uint32_t RECORD_POP = 2;
+
+    //! Log and checkpoint file header.
+    struct file_header {
+      std::uint64_t magic = MAGIC;
+      std::uint64_t epoch = 0;
+    };
+
+    //! Log record header (followed by payload).
+    struct record_header {
+      //! Record type.
+      std::uint32_t type = 0;
+      //! Payload checksum.
+      std::uint32_t checksum = 0;
+    };
+
+  private: // members
+
+    //! Mutex guarding all members.
+    mutable std::mutex mMutex{};
+    //! Signals a sync done.
+    std::condition_variable mCond{};
+    //! In-memory queue.
+    cqueue<T> mQueue{};
+    //! Log file path.
+    std::string mLogPath;
+    //! Checkpoint file path.
+    std::string mCkptPath;
+    //! Compaction policy.
+    walqueue_policy mPolicy;
+    //! Log file descriptor.
+    int mLogFd = -1;
+    //! Current epoch.
+    std::uint64_t mEpoch = 0;
+    //! Log size (bytes).
+    std::size_t mLogSize = 0;
+    //! Bytes appended to the log since opening (log sequence number).
+    std::uint64_t mWritten = 0;
+    //! Bytes appended and synced.
+    std::uint64_t mDurable = 0;
+    //! A producer is syncing.
+    bool mSyncing = false;
+    //! Log can not be repaired after a write error (writes rejected).
+    bool mFailed = false;
+    //! Error of a failed log sync (writes rejected until reopened).
+    int mSyncError = 0;
+    //! Number of fdatasync calls done by producers.
+    std::size_t mSyncs = 0;
+
+  private: // static methods
+
+    //! Throw a system error.
+    [[noreturn]] static void fail(const char *what);
+    //! Payload checksum (FNV-1a).
+    static std::uint32_t checksum(const void *data, std::size_t len) noexcept;
+    //! Write all data.
+    static void writeAll(int fd, const void *data, std::size_t len);
+    //! Sync the directory containing path (durable rename).
+    static void syncDir(const std::string &path);
+
+  private: // methods
+
+    //! Recover state from checkpoint and log.
+    void recover();
+    //! Replay log records (returns valid log length).
+    std::size_t replay(const std::vector<std::byte> &log);
+    //! Reset log to an empty one of current epoch.
+    void resetLog();
+    //! Append a record to the log.
+    void append(std::uint32_t type, const void *payload, std::size_t len);
+    //! Checkpoint (lock acquired).
+    void doCheckpoint();
+
+  public: // methods
+
+    //! Constructor (opens or creates path.log and path.ckpt).
+    explicit walqueue(const std::string &path, walqueue_policy policy = {});
+    //! Non-copyable.
+    walqueue(const walqueue &) = delete;
+    //! Non-copyable.
+    walqueue & operator=(const walqueue &) = delete;
+    //! Destructor.
+    ~walqueue();
+
+    //! Return the number of items.
+    size_type size() const { std::lock_guard lock(mMutex); return mQueue.size(); }
+    //! Check if there are items in the queue.
+    [[nodiscard]] bool empty() const { std::lock_guard lock(mMutex); return mQueue.empty(); }
+    //! Log size (bytes).
+    size_type log_size() const { std::lock_guard lock(mMutex); return mLogSize; }
+    //! Number of fdatasync calls done by push().
+    size_type syncs() const { std::lock_guard lock(mMutex); return mSyncs; }
+
+    //! Insert an item (returns when durable).
+    void push(const T &val);
+    //! Remove the front item (nullopt if empty).
+    std::optional<T> try_pop();
+    //! Save the queue and truncate the log.
+    void checkpoint();
+};
+
+} // namespace gto
+
+/**
+ * @param[in] what Failed function.
+ * @exception std::system_error Always (aborts when exceptions are disabled).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::fail(const char *what) {
+  CQUEUE_THROW(std::system_error(errno, std::generic_category(), what));
+  std::abort();
+}
+
+/**
+ * @param[in] data Payload.
+ * @param[in] len Payload length.
+ * @return 32-bits FNV-1a hash.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+std::uint32_t gto::walqueue<T>::checksum(const void *data, std::size_t len) noexcept {
+  std::uint32_t ret = 2166136261u;
+  const auto *ptr = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < len; ++i) {
+    ret = (ret ^ ptr[i]) * 16777619u;
+  }
+  return ret;
+}
+
+/**
+ * @param[in] fd File descriptor.
+ * @param[in] data Data to write.
+ * @param[in] len Data length.
+ * @exception std::system_error Write error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::writeAll(int fd, const void *data, std::size_t len) {
+  const auto *ptr = static_cast<const std::byte *>(data);
+  while (len > 0) {
+    ssize_t rc = ::write(fd, ptr, len);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      fail("write");
+    }
+    ptr += rc;
+    len -= static_cast<std::size_t>(rc);
+  }
+}
+
+/**
+ * @param[in] path File path.
+ * @exception std::system_error Sync error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::syncDir(const std::string &path) {
+  auto pos = path.find_last_of('/');
+  std::string dir = (pos == std::string::npos ? "." : (pos == 0 ? "/" : path.substr(0, pos)));
+  int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    fail("open");
+  }
+  int rc = ::fsync(fd);
+  ::close(fd);
+  if (rc != 0) {
+    fail("fsync");
+  }
+}
+
+/**
+ * @param[in] path Files path prefix.
+ * @param[in] policy Compaction policy.
+ * @exception std::system_error Files can not be opened, read or written.
+ * @exception std::invalid_argument Files are not compatible.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+gto::walqueue<T>::walqueue(const std::string &path, walqueue_policy policy) :
+  mLogPath{path + ".log"}, mCkptPath{path + ".ckpt"}, mPolicy{policy}
+{
+  mLogFd = ::open(mLogPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (mLogFd < 0) {
+    fail("open");
+  }
+  CQUEUE_TRY {
+    recover();
+  } CQUEUE_CATCH_ALL {
+    ::close(mLogFd);
+    CQUEUE_RETHROW;
+  }
+}
+
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+gto::walqueue<T>::~walqueue() {
+  ::fdatasync(mLogFd);
+  ::close(mLogFd);
+}
+
+/**
+ * @exception std::system_error Files can not be read or written.
+ * @exception std::invalid_argument Files are not compatible.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::recover() {
+  // checkpoint
+  int fd = ::open(mCkptPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    file_header hdr{0, 0};
+    CQUEUE_TRY {
+      if (::read(fd, &hdr, sizeof(hdr)) != sizeof(hdr) || hdr.magic != MAGIC) {
+        CQUEUE_THROW(std::invalid_argument("walqueue incompatible checkpoint"));
+      }
+      load(mQueue, fd);
+    } CQUEUE_CATCH_ALL {
+      ::close(fd);
+      CQUEUE_RETHROW;
+    }
+    ::close(fd);
+    mEpoch = hdr.epoch;
+  }
+  else if (errno != ENOENT) {
+    fail("open");
+  }
+
+  // log
+  struct stat st{};
+  if (::fstat(mLogFd, &st) != 0) {
+    fail("fstat");
+  }
+  std::vector<std::byte> log(static_cast<std::size_t>(st.st_size));
+  if (!log.empty() && ::pread(mLogFd, log.data(), log.size(), 0) != static_cast<ssize_t>(log.size())) {
+    fail("pread");
+  }
+
+  file_header hdr{0, 0};
+  if (log.size() >= sizeof(hdr)) {
+    std::memcpy(&hdr, log.data(), sizeof(hdr));
+  }
+  if (hdr.magic != MAGIC || hdr.epoch != mEpoch) {
+    // empty, or older than checkpoint
+    resetLog();
+    return;
+  }
+
+  std::size_t len = replay(log);
+  if (len < log.size()) {
+    // torn record at the end
+    if (::ftruncate(mLogFd, static_cast<off_t>(len)) != 0 || ::fdatasync(mLogFd) != 0) {
+      fail("ftruncate");
+    }
+  }
+  mLogSize = len;
+}
+
+/**
+ * @param[in] log Log content (including file header).
+ * @return Length of the valid records prefix.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+std::size_t gto::walqueue<T>::replay(const std::vector<std::byte> &log) {
+  std::size_t pos = sizeof(file_header);
+  while (pos + sizeof(record_header) <= log.size()) {
+    record_header rec;
+    std::memcpy(&rec, log.data() + pos, sizeof(rec));
+    const std::byte *payload = log.data() + pos + sizeof(rec);
+    std::size_t avail = log.size() - pos - sizeof(rec);
+
+    if (rec.type == RECORD_PUSH && avail >= sizeof(T) && rec.checksum == checksum(payload, sizeof(T))) {
+      T val;
+      std::memcpy(static_cast<void *>(&val), payload, sizeof(T));
+      mQueue.push_back(val);
+      pos += sizeof(rec) + sizeof(T);
+    }
+    else if (rec.type == RECORD_POP && avail >= sizeof(std::uint64_t) && rec.checksum == checksum(payload, sizeof(std::uint64_t))) {
+      std::uint64_t n = 0;
+      std::memcpy(&n, payload, sizeof(n));
+      mQueue.consume_front(static_cast<size_type>(n), [](T &) {});
+      pos += sizeof(rec) + sizeof(std::uint64_t);
+    }
+    else {
+      break;
+    }
+  }
+  return pos;
+}
+
+/**
+ * @exception std::system_error Write error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::resetLog() {
+  // records appended after a partial header would be discarded by recovery
+  mFailed = true;
+  if (::ftruncate(mLogFd, 0) != 0) {
+    fail("ftruncate");
+  }
+  file_header hdr{MAGIC, mEpoch};
+  writeAll(mLogFd, &hdr, sizeof(hdr));
+  if (::fdatasync(mLogFd) != 0) {
+    fail("fdatasync");
+  }
+  mFailed = false;
+  mLogSize = sizeof(hdr);
+  mDurable = mWritten;
+  mCond.notify_all();
+}
+
+/**
+ * @details Record is written in a single write() call (O_APPEND). On a
+ *          write error (eg. ENOSPC) the partial record is truncated, so
+ *          that later records are not hidden behind it during recovery.
+ *          If it can not be truncated the queue rejects further writes.
+ * @param[in] type Record type.
+ * @param[in] payload Record payload.
+ * @param[in] len Payload length.
+ * @exception std::system_error Write error, or log failed previously.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::append(std::uint32_t type, const void *payload, std::size_t len) {
+  alignas(std::uint64_t) std::byte buf[sizeof(record_header) + std::max(sizeof(T), sizeof(std::uint64_t))];
+  record_header rec{type, checksum(payload, len)};
+  std::memcpy(buf, &rec, sizeof(rec));
+  std::memcpy(buf + sizeof(rec), payload, len);
+  if (mSyncError != 0) {
+    CQUEUE_THROW(std::system_error(mSyncError, std::generic_category(), "walqueue log sync failed"));
+  }
+  if (mFailed) {
+    CQUEUE_THROW(std::system_error(EIO, std::generic_category(), "walqueue log failed"));
+  }
+  CQUEUE_TRY {
+    writeAll(mLogFd, buf, sizeof(rec) + len);
+  } CQUEUE_CATCH_ALL {
+    if (::ftruncate(mLogFd, static_cast<off_t>(mLogSize)) != 0) {
+      mFailed = true;
+    }
+    CQUEUE_RETHROW;
+  }
+  mLogSize += sizeof(rec) + len;
+  mWritten += sizeof(rec) + len;
+}
+
+/**
+ * @details New checkpoint (next epoch) is written to a temporary file,
+ *          synced, and renamed. Then the log is reset to the new epoch.
+ * @exception std::system_error Files can not be written, or log sync failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::doCheckpoint() {
+  if (mSyncError != 0) {
+    CQUEUE_THROW(std::system_error(mSyncError, std::generic_category(), "walqueue log sync failed"));
+  }
+  std::string tmpPath = mCkptPath + ".tmp";
+  int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    fail("open");
+  }
+  CQUEUE_TRY {
+    file_header hdr{MAGIC, mEpoch + 1};
+    writeAll(fd, &hdr, sizeof(hdr));
+    save(mQueue, fd);
+    if (::fdatasync(fd) != 0) {
+      fail("fdatasync");
+    }
+  } CQUEUE_CATCH_ALL {
+    ::close(fd);
+    CQUEUE_RETHROW;
+  }
+  ::close(fd);
+  if (::rename(tmpPath.c_str(), mCkptPath.c_str()) != 0) {
+    fail("rename");
+  }
+  syncDir(mCkptPath);
+  mEpoch++;
+  resetLog();
+}
+
+/**
+ * @details Waits for the in-progress sync, if any.
+ * @exception std::system_error Files can not be written.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::checkpoint() {
+  std::unique_lock lock(mMutex);
+  mCond.wait(lock, [this]{ return !mSyncing; });
+  doCheckpoint();
+}
+
+/**
+ * @details Waits until the record is synced. If no producer is syncing,
+ *          this one syncs all the records appended so far. If the sync
+ *          fails, all the producers waiting for it throw (their items
+ *          are not durable) and the queue rejects further writes.
+ * @param[in] val Value to add.
+ * @exception std::system_error Log write or sync error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::walqueue<T>::push(const T &val) {
+  std::unique_lock lock(mMutex);
+  append(RECORD_PUSH, &val, sizeof(T));
+  mQueue.push_back(val);
+  std::uint64_t lsn = mWritten;
+
+  while (mDurable < lsn) {
+    if (mSyncError != 0) {
+      CQUEUE_THROW(std::system_error(mSyncError, std::generic_category(), "walqueue log sync failed"));
+    }
+    if (mSyncing) {
+      mCond.wait(lock);
+      continue;
+    }
+    // group commit leader
+    mSyncing = true;
+    std::uint64_t target = mWritten;
+    lock.unlock();
+    int rc = ::fdatasync(mLogFd);
+    int error = errno;
+    lock.lock();
+    mSyncing = false;
+    if (rc != 0) {
+      mSyncError = (error != 0 ? error : EIO);
+    }
+    mCond.notify_all();
+    if (rc != 0) {
+      continue;
+    }
+    mDurable = std::max(mDurable, target);
+    mSyncs++;
+  }
+
+  if (mPolicy.checkpoint_bytes > 0 && mLogSize > mPolicy.checkpoint_bytes && !mSyncing) {
+    doCheckpoint();
+  }
+}
+
+/**
+ * @details Appends a pop record (not synced). The log is truncated when
+ *          the queue becomes empty and the log is big enough.
+ * @return Removed element, or nullopt if there are no elements in the queue.
+ * @exception std::system_error Log write error.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::walqueue<T>::try_pop() -> std::optional<T> {
+  std::lock_guard lock(mMutex);
+  if (mQueue.empty()) {
+    return std::nullopt;
+  }
+  std::uint64_t n = 1;
+  append(RECORD_POP, &n, sizeof(n));
+  T ret = mQueue.pop_front();
+
+  if (!mSyncing) {
+    if (mQueue.empty() && mLogSize > mPolicy.truncate_bytes) {
+      doCheckpoint();
+    }
+    else if (mPolicy.checkpoint_bytes > 0 && mLogSize > mPolicy.checkpoint_bytes) {
+      doCheckpoint();
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,125 @@
+#include "cqueue.hpp"
+#include "wsdeque.hpp"
+
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <iostream>
+
+#define NUM_WORKERS 4
+#define RANGE_SIZE 50'000'000
+#define GRAIN_SIZE 256
+#define NUM_ITERATIONS 5
+
+// g++ -std=c++20 -O3 -pthread -o wsdeque-prof wsdeque-prof.cpp
+// Fork/join workload: a range is split recursively into tasks until they are
+// smaller than GRAIN_SIZE; workers pop their own tasks and steal when idle.
+
+using namespace gto;
+
+//! Fork/join task (sum of range [lo, hi)).
+struct task {
+  std::uint32_t lo;
+  std::uint32_t hi;
+};
+
+//! Per-worker task queue guarded by a mutex.
+class locked_queue
+{
+  private:
+    std::mutex mMutex;
+    cqueue<task> mQueue;
+  public:
+    locked_queue() : mMutex(), mQueue() {}
+    void push(task val) {
+      std::lock_guard lock(mMutex);
+      mQueue.push_back(val);
+    }
+    std::optional<task> pop() {
+      std::lock_guard lock(mMutex);
+      return mQueue.try_pop_back();
+    }
+    std::optional<task> steal() {
+      std::lock_guard lock(mMutex);
+      return mQueue.try_pop_front();
+    }
+};
+
+/**
+ * @brief Run the fork/join workload.
+ * @return Computed sum.
+ */
+template<typename Queue>
+std::uint64_t run() {
+  std::vector<Queue> queues(NUM_WORKERS);
+  std::atomic<std::uint64_t> sum = 0;
+  std::atomic<std::uint64_t> pending = RANGE_SIZE;
+
+  queues[0].push(task{0, RANGE_SIZE});
+
+  auto worker = [&](std::size_t id) {
+    std::uint64_t local = 0;
+    std::uint64_t seed = id + 1;
+    while (pending.load(std::memory_order_relaxed) > 0) {
+      auto item = queues[id].pop();
+      for (std::size_t i = 0; !item && i < NUM_WORKERS; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::size_t victim = static_cast<std::size_t>(seed >> 33) % NUM_WORKERS;
+        if (victim != id) {
+          item = queues[victim].steal();
+        }
+      }
+      if (!item) {
+        std::this_thread::yield();
+        continue;
+      }
+      task t = *item;
+      // fork
+      while (t.hi - t.lo > GRAIN_SIZE) {
+        std::uint32_t mid = t.lo + (t.hi - t.lo) / 2;
+        queues[id].push(task{mid, t.hi});
+        t.hi = mid;
+      }
+      // compute leaf
+      for (std::uint32_t i = t.lo; i < t.hi; i++) {
+        local += i;
+      }
+      pending.fetch_sub(t.hi - t.lo, std::memory_order_relaxed);
+    }
+    sum.fetch_add(local);
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < NUM_WORKERS; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return sum.load();
+}
+
+template<typename Queue>
+void measure(const char *name) {
+  std::uint64_t expected = static_cast<std::uint64_t>(RANGE_SIZE) * (RANGE_SIZE - 1) / 2;
+  auto t1 = std::chrono::steady_clock::now();
+  for (int i = 0; i < NUM_ITERATIONS; i++) {
+    if (run<Queue>() != expected) {
+      std::cerr << "error: wrong result" << std::endl;
+    }
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  std::cout
+      << name << " elapsed time in microseconds : "
+      << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count()
+      << " µs\n";
+}
+
+int main() {
+  measure<wsdeque<task>>("wsdeque");
+  measure<locked_queue>("cqueue+mutex");
+}
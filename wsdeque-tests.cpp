@@ -0,0 +1,124 @@
+#include <set>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+#include "wsdeque.hpp"
+
+using gto::wsdeque;
+
+TEST_CASE("wsdeque") {
+
+  SECTION("default constructor") {
+    wsdeque<int> queue;
+    CHECK(queue.size() == 0);
+    CHECK(queue.empty());
+    CHECK(queue.reserved() == 64);
+    CHECK(!queue.pop().has_value());
+    CHECK(!queue.steal().has_value());
+  }
+
+  SECTION("capacity") {
+    CHECK(wsdeque<int>(1).reserved() == 64);
+    CHECK(wsdeque<int>(100).reserved() == 128);
+    CHECK(wsdeque<int>(128).reserved() == 128);
+  }
+
+  SECTION("owner-lifo") {
+    wsdeque<int> queue;
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    CHECK(queue.size() == 3);
+    CHECK(queue.pop() == 3);
+    CHECK(queue.pop() == 2);
+    CHECK(queue.pop() == 1);
+    CHECK(!queue.pop().has_value());
+    CHECK(queue.empty());
+  }
+
+  SECTION("thief-fifo") {
+    wsdeque<int> queue;
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+    CHECK(queue.steal() == 1);
+    CHECK(queue.steal() == 2);
+    CHECK(queue.pop() == 3);
+    CHECK(!queue.steal().has_value());
+    CHECK(!queue.pop().has_value());
+  }
+
+  SECTION("grow") {
+    wsdeque<std::size_t> queue(64);
+    for (std::size_t i = 0; i < 30; i++) {
+      queue.push(i);
+    }
+    for (std::size_t i = 0; i < 30; i++) {
+      REQUIRE(queue.steal() == i);
+    }
+    // ring indexes wrapped
+    for (std::size_t i = 0; i < 1000; i++) {
+      queue.push(i);
+    }
+    CHECK(queue.reserved() == 1024);
+    CHECK(queue.size() == 1000);
+    CHECK(queue.steal() == 0);
+    for (std::size_t i = 999; i > 0; i--) {
+      REQUIRE(queue.pop() == i);
+    }
+    CHECK(queue.empty());
+  }
+
+  SECTION("concurrent") {
+    constexpr std::size_t N = 200'000;
+    constexpr std::size_t NUM_THIEVES = 3;
+    wsdeque<std::size_t> queue;
+    std::atomic<bool> done = false;
+    std::vector<std::vector<std::size_t>> stolen(NUM_THIEVES);
+    std::vector<std::thread> thieves;
+
+    for (std::size_t t = 0; t < NUM_THIEVES; t++) {
+      thieves.emplace_back([&queue, &done, &items = stolen[t]]() {
+        while (!done.load(std::memory_order_acquire) || !queue.empty()) {
+          if (auto val = queue.steal()) {
+            items.push_back(*val);
+          }
+        }
+      });
+    }
+
+    std::vector<std::size_t> popped;
+    for (std::size_t i = 0; i < N; i++) {
+      queue.push(i);
+      if (i % 3 == 0) {
+        if (auto val = queue.pop()) {
+          popped.push_back(*val);
+        }
+      }
+    }
+    while (auto val = queue.pop()) {
+      popped.push_back(*val);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto &thief : thieves) {
+      thief.join();
+    }
+
+    // each item taken exactly once
+    std::vector<bool> seen(N, false);
+    std::size_t count = 0;
+    auto check = [&](std::size_t val) {
+      REQUIRE(val < N);
+      REQUIRE(!seen[val]);
+      seen[val] = true;
+      count++;
+    };
+    for (auto val : popped) check(val);
+    for (auto &items : stolen) {
+      for (auto val : items) check(val);
+    }
+    CHECK(count == N);
+  }
+
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include "cqueue.hpp"
+
+namespace gto {
+
+/**
+ * @brief Lock-free work-stealing deque (Chase-Lev).
+ *
+ * @details The owner thread pushes and pops at the back (LIFO), while
+ *          other threads steal from the front (FIFO). Items are stored
+ *          in a growable power-of-two ring, like cqueue. When the ring
+ *          is full the owner allocates a ring twice as large; old rings
+ *          can still be read by in-flight thieves, so they are retired
+ *          (kept in a cqueue) and released on destruction.
+ *
+ * @note push() and pop() must be called only from the owner thread.
+ *       steal(), size() and empty() can be called from any thread.
+ *
+ * @see https://doi.org/10.1145/1073970.1073974 (Chase, Lev)
+ * @see https://doi.org/10.1145/2442516.2442524 (Lê et al., weak memory models)
+ *
+ * @tparam T Elements type (trivially copyable, eg. a task pointer).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+class wsdeque
+{
+  private: // declarations
+
+    //! Circular buffer of atomic slots (size is a power of 2).
+    struct ring {
+      std::int64_t mask;
+      std::unique_ptr<std::atomic<T>[]> slots;
+
+      explicit ring(std::int64_t size) : mask{size - 1}, slots{new std::atomic<T>[static_cast<std::size_t>(size)]} {}
+      std::int64_t size() const noexcept { return mask + 1; }
+      T get(std::int64_t i) const noexcept { return slots[static_cast<std::size_t>(i & mask)].load(std::memory_order_relaxed); }
+      void put(std::int64_t i, T val) noexcept { slots[static_cast<std::size_t>(i & mask)].store(val, std::memory_order_relaxed); }
+    };
+
+  public: // declarations
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+  private: // static members
+
+    //! Default initial capacity (power of 2).
+    static constexpr std::int64_t MIN_ALLOCATE = 64;
+    //! Cache line size (avoid false sharing between top and bottom).
+    static constexpr std::size_t CACHE_LINE = 64;
+
+  private: // members
+
+    //! Index of the front item (incremented by thieves).
+    alignas(CACHE_LINE) std::atomic<std::int64_t> mTop = 0;
+    //! Index following the back item (modified by owner).
+    alignas(CACHE_LINE) std::atomic<std::int64_t> mBottom = 0;
+    //! Current ring.
+    std::atomic<ring *> mRing = nullptr;
+    //! Allocated rings, current one at the back (owner only).
+    cqueue<std::unique_ptr<ring>> mRings{};
+
+  private: // methods
+
+    //! Replace current ring by a bigger one.
+    ring * grow(ring *old, std::int64_t top, std::int64_t bottom);
+
+  public: // methods
+
+    //! Constructor (capacity rounded up to a power of 2).
+    explicit wsdeque(size_type capacity = MIN_ALLOCATE);
+    //! Non-copyable.
+    wsdeque(const wsdeque &) = delete;
+    //! Non-copyable.
+    wsdeque & operator=(const wsdeque &) = delete;
+    //! Destructor (releases all rings).
+    ~wsdeque() = default;
+
+    //! Approximate number of items.
+    size_type size() const noexcept;
+    //! Check if there are items (approximate).
+    [[nodiscard]] bool empty() const noexcept { return (size() == 0); }
+    //! Current ring size.
+    size_type reserved() const noexcept { return static_cast<size_type>(mRing.load(std::memory_order_relaxed)->size()); }
+
+    //! Insert an item at the back (owner only).
+    void push(T val);
+    //! Remove the back item (owner only).
+    std::optional<T> pop() noexcept;
+    //! Remove the front item (any thread).
+    std::optional<T> steal() noexcept;
+};
+
+} // namespace gto
+
+/**
+ * @param[in] capacity Initial ring size.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+gto::wsdeque<T>::wsdeque(size_type capacity)
+{
+  std::int64_t size = MIN_ALLOCATE;
+  while (static_cast<size_type>(size) < capacity) {
+    size *= 2;
+  }
+  mRings.push_back(std::make_unique<ring>(size));
+  mRing.store(mRings.back().get(), std::memory_order_relaxed);
+}
+
+/**
+ * @details Value can be outdated when called concurrently.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::wsdeque<T>::size() const noexcept -> size_type {
+  std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+  std::int64_t top = mTop.load(std::memory_order_relaxed);
+  return static_cast<size_type>(bottom > top ? bottom - top : 0);
+}
+
+/**
+ * @details Old ring is retired (not deallocated) because thieves can be
+ *          reading it.
+ * @param[in] old Current ring.
+ * @param[in] top Index of the front item.
+ * @param[in] bottom Index following the back item.
+ * @return New ring.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+auto gto::wsdeque<T>::grow(ring *old, std::int64_t top, std::int64_t bottom) -> ring * {
+  auto tmp = std::make_unique<ring>(old->size() * 2);
+  for (std::int64_t i = top; i < bottom; ++i) {
+    tmp->put(i, old->get(i));
+  }
+  mRings.push_back(std::move(tmp));
+  ring *ret = mRings.back().get();
+  mRing.store(ret, std::memory_order_release);
+  return ret;
+}
+
+/**
+ * @param[in] val Value to add.
+ * @exception std::bad_alloc Ring growth failed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+void gto::wsdeque<T>::push(T val) {
+  std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+  std::int64_t top = mTop.load(std::memory_order_acquire);
+  ring *buf = mRing.load(std::memory_order_relaxed);
+
+  if (bottom - top > buf->size() - 1) {
+    [[unlikely]]
+    buf = grow(buf, top, bottom);
+  }
+
+  buf->put(bottom, val);
+  std::atomic_thread_fence(std::memory_order_release);
+  mBottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+/**
+ * @return The back item, or nullopt if empty (or taken by a thief).
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+std::optional<T> gto::wsdeque<T>::pop() noexcept {
+  std::int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+  ring *buf = mRing.load(std::memory_order_relaxed);
+  mBottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t top = mTop.load(std::memory_order_relaxed);
+
+  if (top > bottom) {
+    // empty
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  T ret = buf->get(bottom);
+
+  if (top == bottom) {
+    // last item, race against thieves
+    bool won = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+    if (!won) {
+      return std::nullopt;
+    }
+  }
+
+  return ret;
+}
+
+/**
+ * @return The front item, or nullopt if empty or another thread won the race.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T>
+std::optional<T> gto::wsdeque<T>::steal() noexcept {
+  std::int64_t top = mTop.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+  if (top >= bottom) {
+    return std::nullopt;
+  }
+
+  // consume ordering is promoted to acquire by compilers
+  ring *buf = mRing.load(std::memory_order_acquire);
+  T ret = buf->get(top);
+
+  if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+    return std::nullopt;
+  }
+
+  return ret;
+}